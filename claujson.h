@@ -7,12 +7,44 @@
 #include "simdjson.h" // modified simdjson 0.9.7
 
 #include <future>
+#include <atomic>
+#include <tuple>
+#include <type_traits>
+#include <limits>
+#include <cmath>
 #include <map>
 #include <vector>
 #include <string>
 #include <set>
+#include <algorithm>
+#include <unordered_map>
+#include <mutex>
+#include <memory>
 #include <fstream>
 #include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <charconv>
+#include <filesystem>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace claujson {
 	using STRING = std::string;
@@ -25,12 +57,179 @@ namespace claujson {
 		int64_t size = 0;
 	};
 
+	// snapshot of PoolManager, see PoolManager::GetStats
+	class PoolStats {
+	public:
+		int64_t total_slots = 0; // calloc'd slots, 0 if pool size is unknown.
+		int64_t live_slots = -1; // pool slots reachable from root, -1 if no root is given.
+		int64_t free_listed_slots = 0; // in dead list.
+		int64_t never_used_slots = 0; // still in blocks.
+		int64_t wasted_slots = -1; // total - live - free_listed - never_used, -1 if no root is given.
+		int64_t live_nodes = -1; // all nodes reachable from root ( pool + new ), -1 if no root is given.
+		int64_t out_of_pool = 0; // FROM_NEW
+		int64_t block_count = 0;
+		int64_t string_bytes = 0; // key and data strings reachable from root.
+
+#ifdef CLAUJSON_POOL_HISTOGRAM
+		// Alloc count by source, indexed by PoolManager::Source.
+		int64_t alloc_count[3] = { 0, 0, 0 };
+		// DeAlloc count by PoolManager::Type.
+		int64_t dealloc_count[3] = { 0, 0, 0 };
+		// Alloc count served by each block.
+		std::vector<int64_t> block_alloc_count;
+#endif
+	};
+
+	// read only memory map of whole file.
+	class MappedFile {
+	private:
+		const uint8_t* _data = nullptr;
+		size_t _size = 0;
+#ifdef _WIN32
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = nullptr;
+#endif
+	public:
+		MappedFile() { }
+		~MappedFile() { close(); }
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+		MappedFile& operator=(MappedFile&& other) noexcept {
+			if (this != &other) {
+				close();
+				std::swap(_data, other._data);
+				std::swap(_size, other._size);
+#ifdef _WIN32
+				std::swap(file, other.file);
+				std::swap(mapping, other.mapping);
+#endif
+			}
+			return *this;
+		}
+
+		const uint8_t* data() const { return _data; }
+		size_t size() const { return _size; }
+		bool is_open() const { return _data != nullptr; }
+
+		bool open(const std::string& fileName) {
+			close();
+#ifdef _WIN32
+			file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE) {
+				return false;
+			}
+			LARGE_INTEGER len;
+			if (!GetFileSizeEx(file, &len) || len.QuadPart == 0) {
+				close();
+				return false;
+			}
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!mapping) {
+				close();
+				return false;
+			}
+			_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			if (!_data) {
+				close();
+				return false;
+			}
+			_size = size_t(len.QuadPart);
+#else
+			int fd = ::open(fileName.c_str(), O_RDONLY);
+			if (fd < 0) {
+				return false;
+			}
+			struct stat st;
+			if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+				::close(fd);
+				return false;
+			}
+			void* ptr = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd); // mapping is still valid.
+			if (ptr == MAP_FAILED) {
+				return false;
+			}
+			_data = static_cast<const uint8_t*>(ptr);
+			_size = size_t(st.st_size);
+#endif
+			return true;
+		}
+
+		void close() {
+#ifdef _WIN32
+			if (_data) {
+				UnmapViewOfFile(_data);
+			}
+			if (mapping) {
+				CloseHandle(mapping);
+			}
+			if (file != INVALID_HANDLE_VALUE) {
+				CloseHandle(file);
+			}
+			mapping = nullptr;
+			file = INVALID_HANDLE_VALUE;
+#else
+			if (_data) {
+				munmap(const_cast<uint8_t*>(_data), _size);
+			}
+#endif
+			_data = nullptr;
+			_size = 0;
+		}
+	};
+
+	// tape and string_buf of lazy subtrees, see ParseOption::lazy_depth, UserType::is_lazy
+	class LazyTape {
+	public:
+		std::unique_ptr<simdjson::dom::parser> parser;
+		int thr_num = 1;
+		bool pack_numeric_array = false;
+	private:
+		std::vector<UserType*> pools; // one pool per expanded subtree.
+		std::mutex mtx;
+		std::mutex expand_mtx; // one expansion at a time, see UserType::expand
+
+		friend class UserType;
+	public:
+		LazyTape() : parser(new simdjson::dom::parser()) { }
+
+		LazyTape(const LazyTape&) = delete;
+		LazyTape& operator=(const LazyTape&) = delete;
+
+		~LazyTape() {
+			for (size_t i = 0; i < pools.size(); ++i) {
+				free(pools[i]);
+			}
+		}
+
+		// slots for expanding subtree, freed with LazyTape.
+		inline UserType* AllocPool(int64_t size);
+	};
+
+	// input text kept by Parse with ParseOption::keep_source, clean subtrees are copied from here by SourceLayout.
+	class SourceText {
+	public:
+		simdjson::padded_string json;
+		std::vector<uint64_t> span; // by tape index of '{' or '[' : begin | end << 32, [begin, end) in json.
+
+		std::string_view get(uint32_t tape_idx) const {
+			const uint64_t x = span[tape_idx];
+			return std::string_view(json.data() + uint32_t(x), size_t((x >> 32) - uint32_t(x)));
+		}
+	};
+
 	class PoolManager {
 	private:
 		UserType* pool = nullptr;
+		int64_t pool_size = 0;
 		std::vector<Block> blocks;
 		UserType* dead_list_start = nullptr;
+		int64_t dead_list_size = 0;
 		std::vector<UserType*> outOfPool;
+		std::unique_ptr<LazyTape> lazy_tape; // nodes of lazy subtrees live here.
 	public:
 		enum class Type {
 			FROM_STATIC = 0, // no dynamic allocation.
@@ -38,6 +237,21 @@ namespace claujson {
 			FROM_NEW   // new + delete.
 		};
 
+		// where Alloc found the space.
+		enum class Source {
+			DEAD_LIST = 0,
+			BLOCK,
+			NEW
+		};
+
+	private:
+#ifdef CLAUJSON_POOL_HISTOGRAM
+		int64_t alloc_count[3] = { 0, 0, 0 };
+		int64_t dealloc_count[3] = { 0, 0, 0 };
+		std::vector<int64_t> block_alloc_count;
+#endif
+
+	public:
 		explicit PoolManager() { }
 
 		explicit PoolManager(UserType* pool, std::vector<Block>&& blocks) {
@@ -45,8 +259,26 @@ namespace claujson {
 			this->blocks = std::move(blocks);
 		}
 
+		// pool_size - number of slots of pool, from Parse.
+		explicit PoolManager(UserType* pool, int64_t pool_size, std::vector<Block>&& blocks) {
+			this->pool = pool;
+			this->pool_size = pool_size;
+			this->blocks = std::move(blocks);
+		}
+
+		// lazy_tape - from Parse with ParseOption::lazy_depth >= 0.
+		explicit PoolManager(UserType* pool, int64_t pool_size, std::vector<Block>&& blocks, std::unique_ptr<LazyTape>&& lazy_tape) {
+			this->pool = pool;
+			this->pool_size = pool_size;
+			this->blocks = std::move(blocks);
+			this->lazy_tape = std::move(lazy_tape);
+		}
+
 		inline void Clear();
 
+		// root - if not nullptr, count live slots and string bytes by walking the tree. O(n)
+		inline PoolStats GetStats(const UserType* root = nullptr) const;
+
 		// init - first time only Blocks... -> no Blocks... ?
 		void AddBlock(int64_t start, int64_t size) {
 			Block block{ start, size };
@@ -239,7 +471,7 @@ namespace claujson {
 		}
 	};
 
-	inline Data& Convert(Data& data, uint64_t* token, bool iskey, const std::unique_ptr<uint8_t[]>& string_buf) {
+	inline Data& Convert(Data& data, const uint64_t* token, bool iskey, const uint8_t* string_buf) {
 		uint8_t type = uint8_t((*token) >> 56);
 		uint64_t payload = (*token) & simdjson::internal::JSON_VALUE_MASK;
 
@@ -257,10 +489,10 @@ namespace claujson {
 
 		switch (type) {
 		case '"': // we have a string
-			std::memcpy(&string_length, string_buf.get() + payload, sizeof(uint32_t));
+			std::memcpy(&string_length, string_buf + payload, sizeof(uint32_t));
 			
 			data.set_str_val(
-				reinterpret_cast<const char*>(string_buf.get() + payload + sizeof(uint32_t)),
+				reinterpret_cast<const char*>(string_buf + payload + sizeof(uint32_t)),
 				string_length
 			);
 
@@ -340,6 +572,98 @@ namespace claujson {
 		}
 	};
 
+	// numeric array, [1, 2, 3] or [0.5, 1.5], without UserType per element.
+	class PackedArray {
+	public:
+		simdjson::internal::tape_type type = simdjson::internal::tape_type::DOUBLE; // INT64, UINT64 or DOUBLE
+
+		std::vector<int64_t> int_val;
+		std::vector<uint64_t> uint_val;
+		std::vector<double> float_val;
+	public:
+		static bool is_packable(simdjson::internal::tape_type type) {
+			return type == simdjson::internal::tape_type::INT64 || type == simdjson::internal::tape_type::UINT64
+				|| type == simdjson::internal::tape_type::DOUBLE;
+		}
+
+		size_t size() const {
+			switch (type) {
+			case simdjson::internal::tape_type::INT64:
+				return int_val.size();
+			case simdjson::internal::tape_type::UINT64:
+				return uint_val.size();
+			default:
+				return float_val.size();
+			}
+		}
+
+		void reserve(size_t len) {
+			switch (type) {
+			case simdjson::internal::tape_type::INT64:
+				int_val.reserve(len);
+				break;
+			case simdjson::internal::tape_type::UINT64:
+				uint_val.reserve(len);
+				break;
+			default:
+				float_val.reserve(len);
+				break;
+			}
+		}
+
+		Data get(size_t idx) const {
+			Data data;
+			data.type = type;
+
+			switch (type) {
+			case simdjson::internal::tape_type::INT64:
+				data.int_val = int_val[idx];
+				break;
+			case simdjson::internal::tape_type::UINT64:
+				data.uint_val = uint_val[idx];
+				break;
+			default:
+				data.float_val = float_val[idx];
+				break;
+			}
+			return data;
+		}
+
+		// false if type is not same.
+		bool push_back(const Data& data) {
+			if (data.type != type) {
+				return false;
+			}
+
+			switch (type) {
+			case simdjson::internal::tape_type::INT64:
+				int_val.push_back(data.int_val);
+				break;
+			case simdjson::internal::tape_type::UINT64:
+				uint_val.push_back(data.uint_val);
+				break;
+			default:
+				float_val.push_back(data.float_val);
+				break;
+			}
+			return true;
+		}
+
+		void erase(size_t idx) {
+			switch (type) {
+			case simdjson::internal::tape_type::INT64:
+				int_val.erase(int_val.begin() + idx);
+				break;
+			case simdjson::internal::tape_type::UINT64:
+				uint_val.erase(uint_val.begin() + idx);
+				break;
+			default:
+				float_val.erase(float_val.begin() + idx);
+				break;
+			}
+		}
+	};
+
 	class UserType {
 	private:
 		inline UserType* make_user_type(UserType* pool, int type) {
@@ -355,7 +679,7 @@ namespace claujson {
 		}
 
 
-		inline UserType* make_user_type(UserType* pool, uint64_t* token, const std::unique_ptr<uint8_t[]>& string_buf, int type) const {
+		inline UserType* make_user_type(UserType* pool, const uint64_t* token, const uint8_t* string_buf, int type) const {
 			Data temp;
 			temp = Convert(temp, token, true, string_buf);
 			(pool) = new (pool) UserType(ItemType(std::move(temp), Data()), type);
@@ -363,14 +687,14 @@ namespace claujson {
 			return pool;
 		}
 
-		inline UserType* make_item_type(UserType* pool, uint64_t* token, uint64_t* token2, const std::unique_ptr<uint8_t[]>& string_buf) const {
+		inline UserType* make_item_type(UserType* pool, const uint64_t* token, const uint64_t* token2, const uint8_t* string_buf) const {
 			(pool) = new (pool) UserType(token, token2, string_buf, 4);
 			
 			pool->alloc_type = PoolManager::Type::FROM_POOL;
 			return pool;
 		}
 
-		UserType* make_item_type(UserType* pool, uint64_t* token2, const std::unique_ptr<uint8_t[]>& string_buf) const {
+		UserType* make_item_type(UserType* pool, const uint64_t* token2, const uint8_t* string_buf) const {
 			(pool) = new (pool) UserType(token2, string_buf, 4);
 			pool->alloc_type = PoolManager::Type::FROM_POOL;
 			return pool;
@@ -406,21 +730,27 @@ namespace claujson {
 		void set_value(const Data& key, const Data& data) {
 			this->value.key = key;
 			this->value.data = data;
+
+			if (parent) { // key is saved by parent.
+				parent->mark_dirty();
+			}
 		}
 
 		UserType* clone() const {
+			expand_lazy();
+
 			UserType* temp = new UserType(this->value);
 
 			temp->type = this->type;
 
 			temp->parent = nullptr; // chk!
 
-			temp->data.reserve(this->data.size());
-
-			for (auto x : this->data) {
-				temp->data.push_back(x->clone());
+			if (this->packed) {
+				temp->packed = new PackedArray(*this->packed);
 			}
 
+			temp->clone_children(this);
+
 			return temp;
 		}
 
@@ -432,12 +762,16 @@ namespace claujson {
 
 		friend PoolManager;
 
-		PoolManager::Type alloc_type;
+		PoolManager::Type alloc_type = PoolManager::Type::FROM_STATIC;
 		uint64_t alloc_idx = 0;
 
 		ItemType value; // equal to key
 		int type = -1; // 0 - object, 1 - array, 2 - virtual object, 3 - virtual array, 4 - item, -1 - root  -2 - only in parse...
+		uint32_t tape_idx = 0; // tape index of '{' or '[', if lazy or clean.
+		bool clean = false; // span in SourceText is same as subtree, see ParseOption::keep_source
 		UserType* parent = nullptr;
+		PackedArray* packed = nullptr; // array of numbers only, then no data.
+		std::atomic<LazyTape*> lazy{ nullptr }; // not expanded yet, then no data. set to nullptr after data is built.
 	public:
 		//inline const static size_t npos = -1; // ?
 		// chk type?
@@ -450,10 +784,12 @@ namespace claujson {
 
 	public:
 
-		inline const std::vector<UserType*>& get_data() const { return data; }
-		inline std::vector<UserType*>& get_data() { return data; }
+		// get_data, get_data_list, get_data_size throw for packed array, see is_packed.
+		inline const std::vector<UserType*>& get_data() const { expand_lazy(); if (packed) { throw "get_data, packed array"; } return data; }
+		inline std::vector<UserType*>& get_data() { expand_lazy(); if (packed) { throw "get_data, packed array"; } return data; }
 
 		UserType* find(std::string_view key) {
+			expand_lazy();
 			for (size_t i = 0; i < data.size(); ++i) {
 				if (data[i]->value.key.is_key && *data[i]->value.key.get_str_val() == key) {
 					return data[i];
@@ -463,6 +799,7 @@ namespace claujson {
 		}
 
 		const UserType* find(std::string_view key) const {
+			expand_lazy();
 			for (size_t i = 0; i < data.size(); ++i) {
 				if (data[i]->value.key.is_key && *data[i]->value.key.get_str_val() == key) {
 					return data[i];
@@ -476,10 +813,11 @@ namespace claujson {
 			: value(other.value),
 			type(other.type), parent(other.parent)
 		{
-			this->data.reserve(other.data.size());
-			for (auto& x : other.data) {
-				this->data.push_back(x->clone());
+			other.expand_lazy();
+			if (other.packed) {
+				this->packed = new PackedArray(*other.packed);
 			}
+			clone_children(&other);
 		}
 
 
@@ -488,6 +826,10 @@ namespace claujson {
 			this->data = std::move(other.data);
 			type = std::move(other.type);
 			parent = std::move(other.parent);
+			std::swap(packed, other.packed);
+			lazy = other.lazy.exchange(nullptr);
+			tape_idx = other.tape_idx;
+			clean = other.clean;
 		}
 
 		UserType& operator=(UserType&& other) noexcept {
@@ -499,6 +841,10 @@ namespace claujson {
 			data = std::move(other.data);
 			type = std::move(other.type);
 			parent = std::move(other.parent);
+			std::swap(packed, other.packed);
+			lazy = other.lazy.exchange(lazy.load());
+			tape_idx = other.tape_idx;
+			clean = other.clean;
 
 			return *this;
 		}
@@ -507,6 +853,38 @@ namespace claujson {
 
 
 	private:
+		// copies of children of other ( and their children.. ) -> children of this, explicit stack, no recursion.
+		void clone_children(const UserType* other) {
+			std::vector<std::pair<const UserType*, UserType*>> _stack; // from, to
+			_stack.emplace_back(other, this);
+
+			while (!_stack.empty()) {
+				const UserType* from = _stack.back().first;
+				UserType* to = _stack.back().second;
+				_stack.pop_back();
+
+				to->data.reserve(from->data.size());
+
+				for (const UserType* x : from->data) {
+					x->expand_lazy();
+
+					UserType* temp = new UserType(x->value);
+					temp->type = x->type;
+					if (x->packed) {
+						temp->packed = new PackedArray(*x->packed);
+					}
+					if (temp->is_user_type()) {
+						temp->parent = to;
+					}
+					to->data.push_back(temp);
+
+					if (!x->data.empty()) {
+						_stack.emplace_back(x, temp);
+					}
+				}
+			}
+		}
+
 		void LinkUserType(UserType* ut) // friend?
 		{
 			data.push_back(ut);
@@ -517,13 +895,62 @@ namespace claujson {
 			this->data.push_back(item);
 		}
 
+		// move ut`s children [first, end) to the end of this.
+		//  O(1) if this has no child, else one memcpy of pointers, no push_back per child.
+		//  parent fixups are done by up to thr_num threads for long list.
+		void AdoptChildren(UserType* ut, size_t first = 0, int thr_num = 1) {
+			const size_t before = this->data.size();
+
+			if (before == 0 && first == 0) {
+				this->data.swap(ut->data);
+			}
+			else if (first < ut->data.size()) {
+				this->data.insert(this->data.end(), ut->data.begin() + first, ut->data.end());
+			}
+			ut->data.clear();
+
+			SetParent(before, this->data.size(), thr_num);
+		}
+
+		// parent of children [start, last) is this.
+		//  thr_num - caller`s budget, 1 if caller is already one of parallel tasks.
+		void SetParent(size_t start, size_t last, int thr_num = 1) {
+			const size_t min_len = 1 << 15;
+			const size_t len = last - start;
+
+			if (len < 2 * min_len || thr_num <= 1) {
+				for (size_t i = start; i < last; ++i) {
+					this->data[i]->parent = this;
+				}
+				return;
+			}
+			if (size_t(thr_num) > len / min_len) {
+				thr_num = int(len / min_len);
+			}
+
+			std::vector<std::future<void>> thr(thr_num);
+			for (int t = 0; t < thr_num; ++t) {
+				const size_t _start = start + len / thr_num * t;
+				const size_t _last = t + 1 == thr_num ? last : start + len / thr_num * (t + 1);
+
+				thr[t] = std::async(std::launch::async, [this, _start, _last]() {
+					for (size_t i = _start; i < _last; ++i) {
+						this->data[i]->parent = this;
+					}
+				});
+			}
+			for (int t = 0; t < thr_num; ++t) {
+				thr[t].get();
+			}
+		}
+
 	private:
-		UserType(uint64_t* token2, const std::unique_ptr<uint8_t[]>& string_buf, int type = -1) : type(type)
+		UserType(const uint64_t* token2, const uint8_t* string_buf, int type = -1) : type(type)
 		{
 			this->value.data = Convert(this->value.data, token2, false, string_buf);
 		}
 
-		UserType(uint64_t* token1, uint64_t* token2, const std::unique_ptr<uint8_t[]>& string_buf, int type = -1) : type(type)
+		UserType(const uint64_t* token1, const uint64_t* token2, const uint8_t* string_buf, int type = -1) : type(type)
 		{
 			this->value.key = Convert(this->value.key, token1, true, string_buf);
 			this->value.data = Convert(this->value.data, token2, false, string_buf);
@@ -544,7 +971,9 @@ namespace claujson {
 			//
 		}
 		virtual ~UserType() {
-			//
+			if (packed) {
+				delete packed;
+			}
 		}
 	public:
 
@@ -572,6 +1001,82 @@ namespace claujson {
 			return type == -1;
 		}
 
+		// not expanded yet, see ParseOption::lazy_depth. no expand.
+		bool is_lazy() const {
+			return lazy != nullptr;
+		}
+
+		// lazy subtree -> UserTypes, also done on first get_data_list, get_data_size, find, ...
+		//  threads may read same UserType, it is expanded once. not with writes to it.
+		inline void expand();
+
+		// subtree is not changed after Parse with ParseOption::keep_source, then saved from source text by SourceLayout.
+		bool is_clean() const {
+			return clean;
+		}
+
+		// this and parents are not clean. done by add_*, remove_*, set_value.
+		//  item has no parent, after changing item in place, call mark_dirty of its container.
+		void mark_dirty() {
+			for (UserType* x = this; x && x->clean; x = x->parent) {
+				x->clean = false;
+			}
+		}
+
+		// packed array has no UserType for elements, get_data_list and get_data_size throw,
+		//  use get_packed_size, get_packed_data or unpack. see ParseOption::pack_numeric_array
+		bool is_packed() const {
+			expand_lazy();
+			return packed != nullptr;
+		}
+
+		size_t get_packed_size() const {
+			expand_lazy();
+			return packed ? packed->size() : 0;
+		}
+
+		// INT64, UINT64 or DOUBLE
+		simdjson::internal::tape_type get_packed_type() const {
+			expand_lazy();
+			return packed ? packed->type : simdjson::internal::tape_type::ROOT;
+		}
+
+		// nullptr if not packed or other type.
+		const int64_t* get_packed_int64() const {
+			expand_lazy();
+			return packed && packed->type == simdjson::internal::tape_type::INT64 ? packed->int_val.data() : nullptr;
+		}
+		const uint64_t* get_packed_uint64() const {
+			expand_lazy();
+			return packed && packed->type == simdjson::internal::tape_type::UINT64 ? packed->uint_val.data() : nullptr;
+		}
+		const double* get_packed_double() const {
+			expand_lazy();
+			return packed && packed->type == simdjson::internal::tape_type::DOUBLE ? packed->float_val.data() : nullptr;
+		}
+
+		Data get_packed_data(size_t idx) const {
+			expand_lazy();
+			return packed->get(idx);
+		}
+
+		// packed array -> array of item types.
+		void unpack(PoolManager& manager) {
+			expand_lazy();
+			if (!packed) {
+				return;
+			}
+
+			const size_t len = packed->size();
+			this->data.reserve(this->data.size() + len);
+			for (size_t i = 0; i < len; ++i) {
+				this->data.push_back(make_item_type(manager.Alloc(), Data(), packed->get(i)));
+			}
+
+			delete packed;
+			packed = nullptr;
+		}
+
 		// name key check?
 		void add_object_element(PoolManager& manager, const claujson::Data& name, const claujson::Data& data) {
 			// todo - chk this->type == 0 (object) but name is empty
@@ -580,10 +1085,12 @@ namespace claujson {
 			if (this->type == 1) {
 				throw "Error add object element to array in add_object_element ";
 			}
+			expand_lazy();
 			if (this->type == -1 && this->data.size() >= 1) {
 				throw "Error not valid json in add_object_element";
 			}
 
+			mark_dirty();
 			this->data.push_back(make_item_type(manager.Alloc(), name, data));
 		}
 
@@ -594,23 +1101,49 @@ namespace claujson {
 			if (this->type == 0) {
 				throw "Error add object element to array in add_array_element ";
 			}
+			expand_lazy();
 			if (this->type == -1 && this->data.size() >= 1) {
 				throw "Error not valid json in add_array_element";
 			}
 
+			mark_dirty();
+			if (packed) {
+				if (packed->push_back(data)) {
+					return;
+				}
+				unpack(manager);
+			}
+
 			this->data.push_back(make_item_type(manager.Alloc(), Data(), data)); // (Type*)make_item_type(std::move(temp), data));
 		}
 
+		// explicit stack, no recursion. each node is DeAlloc`ed after its children are taken.
 		void remove_all(PoolManager& manager, UserType* ut) {
-			for (size_t i = 0; i < ut->data.size(); ++i) {
-				if (ut->data[i]) {
-					manager.DeAlloc(ut);
+			ut->mark_dirty();
 
-					remove_all(manager, ut->data[i]);
-					ut->data[i] = nullptr;
+			std::vector<UserType*> _stack;
+			_stack.push_back(ut);
+
+			while (!_stack.empty()) {
+				UserType* x = _stack.back();
+				_stack.pop_back();
+
+				x->lazy = nullptr;
+				if (x->packed) {
+					delete x->packed;
+					x->packed = nullptr;
+				}
+				for (size_t i = 0; i < x->data.size(); ++i) {
+					if (x->data[i]) {
+						_stack.push_back(x->data[i]);
+					}
+				}
+				x->data.clear();
+
+				if (x != ut) {
+					manager.DeAlloc(x);
 				}
 			}
-			ut->data.clear();
 		}
 
 		void remove_all(PoolManager& manager) {
@@ -621,6 +1154,7 @@ namespace claujson {
 
 		//todo..
 		void remove_all(UserType* ut) {
+			ut->lazy = nullptr;
 			for (size_t i = 0; i < ut->data.size(); ++i) {
 				if (ut->data[i]) {
 					//remove_all(ut->data[i]);
@@ -642,11 +1176,12 @@ namespace claujson {
 			if (is_array()) {
 				throw "Error in add_object_with_key";
 			}
-
+			expand_lazy();
 			if (this->type == -1 && this->data.size() >= 1) {
 				throw "Error not valid json in add_object_with_key";
 			}
 
+			mark_dirty();
 			this->data.push_back(object);
 			((UserType*)this->data.back())->parent = this;
 		}
@@ -657,11 +1192,12 @@ namespace claujson {
 			if (is_array()) {
 				throw "Error in add_array_with_key";
 			}
-
+			expand_lazy();
 			if (this->type == -1 && this->data.size() >= 1) {
 				throw "Error not valid json in add_array_with_key";
 			}
 
+			mark_dirty();
 			this->data.push_back(_array);
 			((UserType*)this->data.back())->parent = this;
 		}
@@ -672,11 +1208,16 @@ namespace claujson {
 			if (is_object()) {
 				throw "Error in add_object_with_no_key";
 			}
+			expand_lazy();
+			if (packed) {
+				throw "Error packed array, unpack first in add_object_with_no_key";
+			}
 
 			if (this->type == -1 && this->data.size() >= 1) {
 				throw "Error not valid json in add_object_with_no_key";
 			}
 
+			mark_dirty();
 			this->data.push_back(object);
 			((UserType*)this->data.back())->parent = this;
 		}
@@ -687,11 +1228,16 @@ namespace claujson {
 			if (is_object()) {
 				throw "Error in add_array_with_no_key";
 			}
+			expand_lazy();
+			if (packed) {
+				throw "Error packed array, unpack first in add_array_with_no_key";
+			}
 
 			if (this->type == -1 && this->data.size() >= 1) {
 				throw "Error not valid json in add_array_with_no_key";
 			}
 
+			mark_dirty();
 			this->data.push_back(_array);
 			((UserType*)this->data.back())->parent = this;
 		}
@@ -702,6 +1248,12 @@ namespace claujson {
 
 	private:
 
+		inline void expand_lazy() const {
+			if (lazy.load(std::memory_order_acquire)) {
+				const_cast<UserType*>(this)->expand();
+			}
+		}
+
 		inline void add_user_type(UserType* ut) {
 			this->data.push_back(ut);
 			ut->parent = this;
@@ -733,7 +1285,7 @@ namespace claujson {
 			return ut;
 		}
 
-		inline void add_user_type(UserType* pool, uint64_t* token, const std::unique_ptr<uint8_t[]>& string_buf, int type) {
+		inline void add_user_type(UserType* pool, const uint64_t* token, const uint8_t* string_buf, int type) {
 			// todo - chk this->type == 0 (object) but name is empty
 			// todo - chk this->type == 1 (array) but name is not empty.
 			// todo - chk this->type == -1 .. one object or one array or data(true or false or null or string or number).
@@ -766,7 +1318,7 @@ namespace claujson {
 		}
 
 		// add item_type in object? key = value
-		inline void add_item_type(UserType* pool, uint64_t* token, uint64_t* token2, const std::unique_ptr<uint8_t[]>& string_buf) {
+		inline void add_item_type(UserType* pool, const uint64_t* token, const uint64_t* token2, const uint8_t* string_buf) {
 			// todo - chk this->type == 0 (object) but name is empty
 			// todo - chk this->type == 1 (array) but name is not empty.
 
@@ -780,7 +1332,7 @@ namespace claujson {
 			}
 		}
 
-		inline void add_item_type(UserType* pool, uint64_t* token2, const std::unique_ptr<uint8_t[]>& string_buf) {
+		inline void add_item_type(UserType* pool, const uint64_t* token2, const uint8_t* string_buf) {
 			// todo - chk this->type == 0 (object) but name is empty
 			// todo - chk this->type == 1 (array) but name is not empty.
 
@@ -803,6 +1355,48 @@ namespace claujson {
 			this->data.push_back(make_item_type(pool, name, data));
 		}
 
+		// tokens - values of array, packed if all are numbers of same type. ( ParseOption::pack_numeric_array )
+		inline bool make_packed(const std::vector<const uint64_t*>& tokens) {
+			const simdjson::internal::tape_type type = static_cast<simdjson::internal::tape_type>((*tokens[0]) >> 56);
+
+			if (!PackedArray::is_packable(type)) {
+				return false;
+			}
+			for (size_t i = 1; i < tokens.size(); ++i) {
+				if (static_cast<simdjson::internal::tape_type>((*tokens[i]) >> 56) != type) {
+					return false;
+				}
+			}
+
+			packed = new PackedArray();
+			packed->type = type;
+
+			switch (type) {
+			case simdjson::internal::tape_type::INT64:
+				packed->int_val.resize(tokens.size());
+				for (size_t i = 0; i < tokens.size(); ++i) {
+					packed->int_val[i] = int64_t(*(tokens[i] + 1));
+				}
+				break;
+			case simdjson::internal::tape_type::UINT64:
+				packed->uint_val.resize(tokens.size());
+				for (size_t i = 0; i < tokens.size(); ++i) {
+					packed->uint_val[i] = *(tokens[i] + 1);
+				}
+				break;
+			default:
+				packed->float_val.resize(tokens.size());
+				for (size_t i = 0; i < tokens.size(); ++i) {
+					std::memcpy(&packed->float_val[i], tokens[i] + 1, sizeof(double));
+				}
+				break;
+			}
+
+			std::vector<UserType*>().swap(data); // reserved at array start.
+
+			return true;
+		}
+
 		inline void add_item_type(UserType* pool, const claujson::Data& data) {
 			// todo - chk this->type == 0 (object) but name is empty
 			// todo - chk this->type == 1 (array) but name is not empty.
@@ -817,18 +1411,44 @@ namespace claujson {
 	public:
 
 		UserType*& get_data_list(size_t idx) {
+			expand_lazy();
+			if (packed) {
+				throw "get_data_list, packed array";
+			}
 			return this->data[idx];
 		}
 		const UserType* const& get_data_list(size_t idx) const {
+			expand_lazy();
+			if (packed) {
+				throw "get_data_list, packed array";
+			}
 			return this->data[idx];
 		}
 
 		size_t get_data_size() const {
+			expand_lazy();
+			if (packed) {
+				throw "get_data_size, packed array";
+			}
+			return this->data.size();
+		}
+
+	private:
+		// get_data_size without check, 0 for packed array.
+		size_t get_child_size() const {
+			expand_lazy();
 			return this->data.size();
 		}
+	public:
 
 
 		void remove_data_list(PoolManager& manager, size_t idx) {
+			expand_lazy();
+			mark_dirty();
+			if (packed) {
+				packed->erase(idx);
+				return;
+			}
 			manager.DeAlloc(data[idx]);
 			data.erase(data.begin() + idx);
 		}
@@ -845,37 +1465,218 @@ namespace claujson {
 	};
 
 
-	inline void PoolManager::Clear() {
-		if (pool) {
-			free(pool); //
-		}
-		pool = nullptr;
-		blocks.clear();
-		dead_list_start = nullptr;
-		for (size_t i = 0; i < outOfPool.size(); ++i) {
-			delete outOfPool[i];
-		}
-		outOfPool.clear();
+	inline UserType* LazyTape::AllocPool(int64_t size) {
+		UserType* pool = (UserType*)calloc(size, sizeof(UserType));
+		std::lock_guard<std::mutex> lock(mtx);
+		pools.push_back(pool);
+		return pool;
 	}
 
-	inline UserType* PoolManager::Alloc() {
-		// 1. find space for dead_list.
-		if (dead_list_start) {
-			UserType* x = dead_list_start;
-			dead_list_start = dead_list_start->next_dead;
+	// depth-first walk with explicit stack, no recursion, no depth limit. stack is reused after reset.
+	//  containers are visited before children ( is_post() == false ) and after ( is_post() == true ),
+	//  items once. elements of packed array are not nodes, see UserType::is_packed.
+	//  for (UserType* x = it.next(); x; x = it.next()) { if (!it.is_post()) { ... } }
+	class TreeIterator {
+	private:
+		class Frame {
+		public:
+			UserType* ut;
+			size_t idx;
+		};
 
-			new (x) UserType();
-			x->alloc_type = PoolManager::Type::FROM_POOL;
-			return x;
+		std::vector<Frame> _stack;
+		UserType* root = nullptr;
+		UserType* now = nullptr;
+		bool started = false;
+		bool post = false;
+		bool enter = false; // now is container, not entered yet.
+	public:
+		explicit TreeIterator(UserType* root = nullptr) {
+			reset(root);
 		}
 
-		// 2. find space for blocks.
-		for (uint64_t i = 0; i < blocks.size(); ++i) {
-			if (blocks[i].size > 0) {
-				UserType* x = pool + blocks[i].start;
+		void reset(UserType* root) {
+			_stack.clear();
+			this->root = root;
+			now = nullptr;
+			started = false;
+			post = false;
+			enter = false;
+		}
 
-				++blocks[i].start;
-				--blocks[i].size;
+		// next node, root is first, nullptr at end.
+		UserType* next() {
+			if (!started) {
+				started = true;
+				return root ? visit(root) : nullptr;
+			}
+
+			if (enter) {
+				_stack.push_back(Frame{ now, 0 });
+				enter = false;
+			}
+
+			if (_stack.empty()) {
+				now = nullptr;
+				return nullptr;
+			}
+
+			Frame& top = _stack.back();
+			if (!top.ut->is_packed() && top.idx < top.ut->get_data_size()) {
+				return visit(top.ut->get_data_list(top.idx++));
+			}
+
+			now = top.ut;
+			post = true;
+			_stack.pop_back();
+			return now;
+		}
+
+		// after pre-order visit of container, its children are skipped, post-order visit is next.
+		void skip_children() {
+			if (enter) {
+				_stack.push_back(Frame{ now, (size_t)-1 });
+				enter = false;
+			}
+		}
+
+		bool is_post() const {
+			return post;
+		}
+
+		// of node from next(), 0 for root. ( before skip_children )
+		size_t depth() const {
+			return _stack.size();
+		}
+	private:
+		UserType* visit(UserType* x) {
+			now = x;
+			post = false;
+			enter = x->is_user_type();
+			return x;
+		}
+	};
+
+	inline void PoolManager::Clear() {
+		if (pool) {
+			free(pool); //
+		}
+		pool = nullptr;
+		pool_size = 0;
+		blocks.clear();
+		dead_list_start = nullptr;
+		dead_list_size = 0;
+		for (size_t i = 0; i < outOfPool.size(); ++i) {
+			delete outOfPool[i];
+		}
+		outOfPool.clear();
+		lazy_tape.reset();
+#ifdef CLAUJSON_POOL_HISTOGRAM
+		for (int i = 0; i < 3; ++i) {
+			alloc_count[i] = 0;
+			dealloc_count[i] = 0;
+		}
+		block_alloc_count.clear();
+#endif
+	}
+
+	inline PoolStats PoolManager::GetStats(const UserType* root) const {
+		PoolStats stats;
+
+		stats.total_slots = pool_size;
+		stats.free_listed_slots = dead_list_size;
+		stats.out_of_pool = outOfPool.size();
+		stats.block_count = blocks.size();
+
+		for (uint64_t i = 0; i < blocks.size(); ++i) {
+			if (blocks[i].size > 0) {
+				stats.never_used_slots += blocks[i].size;
+			}
+		}
+
+		if (root) {
+			const size_t sso_capacity = std::string().capacity();
+			int64_t live_slots = 0;
+			int64_t live_nodes = 0;
+
+			std::vector<const UserType*> _stack;
+			_stack.push_back(root);
+
+			while (!_stack.empty()) {
+				const UserType* ut = _stack.back();
+				_stack.pop_back();
+
+				if (ut != root) {
+					++live_nodes;
+					if (ut->alloc_type == Type::FROM_POOL && pool <= ut && ut < pool + pool_size) {
+						++live_slots;
+					}
+				}
+
+				for (const std::string* str : { ut->value.key.get_str_val(), ut->value.data.get_str_val() }) {
+					if (str) { // new std::string + heap buffer if not in small string buffer.
+						stats.string_bytes += sizeof(std::string) + (str->capacity() > sso_capacity ? str->capacity() + 1 : 0);
+					}
+				}
+
+				for (size_t i = 0; i < ut->data.size(); ++i) {
+					if (ut->data[i]) {
+						_stack.push_back(ut->data[i]);
+					}
+				}
+			}
+
+			stats.live_slots = live_slots;
+			stats.live_nodes = live_nodes;
+			stats.wasted_slots = stats.total_slots - live_slots - stats.free_listed_slots - stats.never_used_slots;
+			if (stats.wasted_slots < 0) { // pool_size is unknown.
+				stats.wasted_slots = 0;
+			}
+		}
+
+#ifdef CLAUJSON_POOL_HISTOGRAM
+		for (int i = 0; i < 3; ++i) {
+			stats.alloc_count[i] = alloc_count[i];
+			stats.dealloc_count[i] = dealloc_count[i];
+		}
+		stats.block_alloc_count = block_alloc_count;
+		stats.block_alloc_count.resize(blocks.size(), 0);
+#endif
+
+		return stats;
+	}
+
+	inline UserType* PoolManager::Alloc() {
+		// 1. find space for dead_list.
+		if (dead_list_start) {
+			UserType* x = dead_list_start;
+			dead_list_start = dead_list_start->next_dead;
+			--dead_list_size;
+
+#ifdef CLAUJSON_POOL_HISTOGRAM
+			++alloc_count[(int)Source::DEAD_LIST];
+#endif
+
+			new (x) UserType();
+			x->alloc_type = PoolManager::Type::FROM_POOL;
+			return x;
+		}
+
+		// 2. find space for blocks.
+		for (uint64_t i = 0; i < blocks.size(); ++i) {
+			if (blocks[i].size > 0) {
+				UserType* x = pool + blocks[i].start;
+
+				++blocks[i].start;
+				--blocks[i].size;
+
+#ifdef CLAUJSON_POOL_HISTOGRAM
+				++alloc_count[(int)Source::BLOCK];
+				if (block_alloc_count.size() < blocks.size()) {
+					block_alloc_count.resize(blocks.size(), 0);
+				}
+				++block_alloc_count[i];
+#endif
 
 				new (x) UserType();
 				x->alloc_type = PoolManager::Type::FROM_POOL;
@@ -883,6 +1684,10 @@ namespace claujson {
 			}
 		}
 
+#ifdef CLAUJSON_POOL_HISTOGRAM
+		++alloc_count[(int)Source::NEW];
+#endif
+
 		// 3. new in out of pool. (new)
 		outOfPool.push_back(new UserType());
 		outOfPool.back()->alloc_type = PoolManager::Type::FROM_NEW;
@@ -891,11 +1696,16 @@ namespace claujson {
 	}
 
 	inline void PoolManager::DeAlloc(UserType* ut) {
+#ifdef CLAUJSON_POOL_HISTOGRAM
+		++dealloc_count[(int)ut->alloc_type];
+#endif
+
 		// 1-1. from pool?
 		if (ut->alloc_type == PoolManager::Type::FROM_POOL) {
 			// 2. add dead_list..
 			ut->next_dead = this->dead_list_start;
-			this->dead_list_start = ut->next_dead;
+			this->dead_list_start = ut;
+			++this->dead_list_size;
 		}
 		// 1-2. from_outOfPool?
 		else if (ut->alloc_type == PoolManager::Type::FROM_NEW) {
@@ -903,191 +1713,715 @@ namespace claujson {
 			this->outOfPool.back()->alloc_idx = ut->alloc_idx;
 			std::swap(this->outOfPool[ut->alloc_idx], this->outOfPool.back());
 			this->outOfPool.pop_back();
+
+			delete ut;
 		}
 		else { // STATIC
 			// nothing.
 		}
 	}
 
-	class LoadData
-	{
+	// compiled set of JSON Pointers, "*" matches any key or index. ( for ParseOption::projection )
+	//  "/features/*/properties/BLKLOT" - keeps features[i].properties.BLKLOT and containers on the way.
+	//  subtree at the end of pointer is kept fully. "" - whole document.
+	class Projection {
 	public:
-		static int Merge(class UserType* next, class UserType* ut, class UserType** ut_next)
-		{
-
-			// check!!
-			while (ut->get_data_size() >= 1
-				&& (ut->get_data_list(0)->is_user_type()) && (ut->get_data_list(0))->is_virtual())
-			{
-				ut = (UserType*)ut->get_data_list(0);
-			}
+		inline const static uint32_t npos = (uint32_t)-1;
+
+		// all pointers are matched at once. ( subset construction )
+		class State {
+		public:
+			std::map<std::string, uint32_t, std::less<>> next;
+			uint32_t other = npos; // by "*", npos - skip.
+			bool full = false; // keep subtree.
+		};
+	private:
+		std::vector<State> states; // states[0] is for top-level value.
+		bool ok = false;
+	public:
+		Projection() { }
 
-			bool chk_ut_next = false;
+		explicit Projection(const std::vector<std::string>& pointers) {
+			compile(pointers);
+		}
 
-			while (true) {
+		bool compile(const std::vector<std::string>& pointers) {
+			class Node {
+			public:
+				std::map<std::string, int> child;
+				int any = -1;
+				bool full = false;
+			};
 
-				class UserType* _ut = ut;
-				class UserType* _next = next;
+			std::vector<Node> trie(1);
 
+			states.clear();
+			ok = false;
 
-				if (ut_next && _ut == *ut_next) {
-					*ut_next = _next;
-					chk_ut_next = true;
+			for (const std::string& pointer : pointers) {
+				if (!pointer.empty() && pointer[0] != '/') {
+					std::cout << "not valid json pointer " << pointer << "\n";
+					return false;
 				}
 
-				size_t _size = _ut->get_data_size(); // bug fix.. _next == _ut?
-				for (size_t i = 0; i < _size; ++i) {
-					if (_ut->get_data_list(i)->is_user_type()) {
-						if (((UserType*)_ut->get_data_list(i))->is_virtual()) {
-							//_ut->get_user_type_list(i)->used();
+				int now = 0;
+				size_t i = 0;
+				while (i < pointer.size()) {
+					size_t j = pointer.find('/', i + 1);
+					if (j == std::string::npos) {
+						j = pointer.size();
+					}
+
+					std::string token;
+					for (size_t k = i + 1; k < j; ++k) { // ~1 -> /, ~0 -> ~
+						if (pointer[k] == '~' && k + 1 < j && (pointer[k + 1] == '0' || pointer[k + 1] == '1')) {
+							token.push_back(pointer[k + 1] == '0' ? '~' : '/');
+							++k;
 						}
 						else {
-							_next->LinkUserType(_ut->get_data_list(i));
-							_ut->get_data_list(i) = nullptr;
+							token.push_back(pointer[k]);
 						}
 					}
-					else { // item type.
-						_next->LinkItemType(std::move(_ut->get_data_list(i)));
+
+					int next;
+					if (token == "*") {
+						next = trie[now].any;
+					}
+					else {
+						auto x = trie[now].child.find(token);
+						next = x == trie[now].child.end() ? -1 : x->second;
+					}
+					if (next < 0) {
+						next = (int)trie.size();
+						trie.push_back(Node());
+						if (token == "*") {
+							trie[now].any = next;
+						}
+						else {
+							trie[now].child[token] = next;
+						}
 					}
+					now = next;
+					i = j;
 				}
+				trie[now].full = true;
+			}
 
-				_ut->remove_all();
+			std::map<std::vector<int>, uint32_t> index;
+			std::vector<std::vector<int>> sets;
 
-				ut = ut->get_parent();
-				next = next->get_parent();
+			auto add_state = [&](std::vector<int>&& set) -> uint32_t {
+				if (set.empty()) {
+					return npos;
+				}
+				std::sort(set.begin(), set.end());
+				set.erase(std::unique(set.begin(), set.end()), set.end());
 
+				auto x = index.find(set);
+				if (x != index.end()) {
+					return x->second;
+				}
+				const uint32_t id = (uint32_t)states.size();
+				index.insert({ set, id });
+				sets.push_back(std::move(set));
+				states.push_back(State());
+				return id;
+			};
 
-				if (next && ut) {
-					//
+			add_state(std::vector<int>{ 0 });
+
+			for (size_t k = 0; k < sets.size(); ++k) {
+				const std::vector<int> set = sets[k];
+
+				bool full = false;
+				for (int x : set) {
+					full = full || trie[x].full;
 				}
-				else {
-					// right_depth > left_depth
-					if (!next && ut) {
-						return -1;
+				if (full) {
+					states[k].full = true;
+					continue;
+				}
+
+				std::vector<int> other;
+				std::set<std::string> keys;
+				for (int x : set) {
+					if (trie[x].any >= 0) {
+						other.push_back(trie[x].any);
 					}
-					else if (next && !ut) {
-						return 1;
+					for (const auto& child : trie[x].child) {
+						keys.insert(child.first);
 					}
+				}
 
-					return 0;
+				for (const std::string& key : keys) {
+					std::vector<int> next = other;
+					for (int x : set) {
+						auto y = trie[x].child.find(key);
+						if (y != trie[x].child.end()) {
+							next.push_back(y->second);
+						}
+					}
+					const uint32_t id = add_state(std::move(next));
+					states[k].next.insert({ key, id });
 				}
+				const uint32_t id = add_state(std::move(other));
+				states[k].other = id;
 			}
+
+			ok = !pointers.empty();
+			return ok;
 		}
 
-	private:
-		static bool __LoadData(claujson::UserType* _pool, const std::unique_ptr<uint8_t[]>& string_buf, const std::unique_ptr<uint64_t[]>& token_arr,
-			int64_t token_arr_start, size_t token_arr_len, class UserType* _global,
-			int start_state, int last_state, class UserType** next, int* err, int no, UserType*& after_pool)
-		{
-			int a = clock();
+		bool valid() const { return ok; }
 
-			UserType* pool = _pool + token_arr_start;
+		const State& get_state(uint32_t state) const { return states[state]; }
 
-			std::vector<uint64_t*> Vec;
+		// npos - not matched.
+		uint32_t step(uint32_t state, std::string_view key) const {
+			const State& x = states[state];
+			if (x.next.empty()) {
+				return x.other;
+			}
+			auto y = x.next.find(key);
+			return y == x.next.end() ? x.other : y->second;
+		}
 
-			if (token_arr_len <= 0) {
-				*next = nullptr;
-				return false;
+		uint32_t step(uint32_t state, uint64_t idx) const {
+			const State& x = states[state];
+			if (x.next.empty()) {
+				return x.other;
 			}
+			return step(state, std::string_view(std::to_string(idx)));
+		}
+	};
 
-			Data tempData;
+	// shortest text which reads back to x, + ".0" if it looks like an integer. ( not INT64 at parse )
+	//  non-finite -> null. buf : at least 32 chars, returns length.
+	inline size_t FormatDouble(char* buf, double x) {
+		if (!std::isfinite(x)) {
+			std::memcpy(buf, "null", 4);
+			return 4;
+		}
 
-			class UserType& global = *_global;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+		size_t len = std::to_chars(buf, buf + 32, x).ptr - buf;
+#else
+		size_t len = 0;
+		for (int precision = 15; precision <= 17; ++precision) {
+			len = snprintf(buf, 32, "%.*g", precision, x);
+			if (strtod(buf, nullptr) == x) {
+				break;
+			}
+		}
+#endif
+		for (size_t i = 0; i < len; ++i) {
+			if (buf[i] == '.' || buf[i] == 'e' || buf[i] == 'E') {
+				return len;
+			}
+		}
+		buf[len] = '.';
+		buf[len + 1] = '0';
+		return len + 2;
+	}
 
-			int state = start_state;
-			size_t braceNum = 0;
-			std::vector< class UserType* > nestedUT(1);
+	// buf : at least 24 chars, returns length.
+	inline size_t FormatInt64(char* buf, int64_t x) {
+		return std::to_chars(buf, buf + 24, x).ptr - buf;
+	}
 
-			nestedUT.reserve(1024);
-			nestedUT[0] = &global;
+	inline size_t FormatUInt64(char* buf, uint64_t x) {
+		return std::to_chars(buf, buf + 24, x).ptr - buf;
+	}
 
-			int64_t count = 0;
+	// output buffer of LoadData::_save, flushed to FILE* or std::ostream in large writes. ( no sink - kept in memory, see str )
+	class Writer {
+	private:
+		std::string buf;
+		FILE* file = nullptr;
+		std::ostream* stream = nullptr;
+		size_t flush_size;
+		bool fail = false;
+	public:
+		explicit Writer(size_t flush_size = 1 << 22) : flush_size(flush_size) { }
 
-			uint64_t* key = nullptr;
+		explicit Writer(FILE* file, size_t flush_size = 1 << 22) : file(file), flush_size(flush_size) {
+			buf.reserve(flush_size + 1024);
+		}
 
-			for (int64_t i = 0; i < token_arr_len; ++i) {
+		explicit Writer(std::ostream& stream, size_t flush_size = 1 << 22) : stream(&stream), flush_size(flush_size) {
+			buf.reserve(flush_size + 1024);
+		}
 
-				const simdjson::internal::tape_type type =
-					static_cast<simdjson::internal::tape_type>((((token_arr)[token_arr_start + i]) >> 56));
+		Writer(const Writer&) = delete;
+		Writer& operator=(const Writer&) = delete;
 
-				uint64_t payload = (token_arr[token_arr_start + i]) & simdjson::internal::JSON_VALUE_MASK;
+		~Writer() {
+			flush();
+		}
 
+		void push_back(char c) {
+			buf.push_back(c);
+		}
 
-				switch (state)
-				{
-				case 0:
-				{
-					// Left 1
-					switch (type) {
-					case simdjson::internal::tape_type::START_OBJECT:
-					case simdjson::internal::tape_type::START_ARRAY:
-					{ // object start, array start
+		void append(const char* str, size_t len) {
+			buf.append(str, len);
+			if (buf.size() >= flush_size) {
+				flush();
+			}
+		}
 
-						if (!Vec.empty()) {
+		void append(std::string_view str) {
+			append(str.data(), str.size());
+		}
 
-							if (static_cast<simdjson::internal::tape_type>((*Vec[0]) >> 56) == simdjson::internal::tape_type::KEY) {
-								nestedUT[braceNum]->reserve_data_list(nestedUT[braceNum]->get_data_size() + Vec.size() / 2);
-								for (size_t x = 0; x < Vec.size(); x += 2) {
-									nestedUT[braceNum]->add_item_type(pool, Vec[x], Vec[x + 1], string_buf);
-									++pool;
-								}
-							}
-							else {
-								nestedUT[braceNum]->reserve_data_list(nestedUT[braceNum]->get_data_size() + Vec.size());
-								for (size_t x = 0; x < Vec.size(); x += 1) {
-									nestedUT[braceNum]->add_item_type(pool, Vec[x], string_buf);
-									++pool;
-								}
-							}
+		// all of part, part is emptied. no copy into buffer if there is a sink.
+		void append(Writer& part) {
+			if (!file && !stream) {
+				buf.append(part.buf);
+			}
+			else {
+				flush();
+				std::swap(buf, part.buf);
+				flush();
+				std::swap(buf, part.buf);
+			}
+			part.buf.clear();
+		}
 
-							Vec.clear();
-						}
+		void flush() {
+			if (buf.empty() || (!file && !stream)) {
+				return;
+			}
+			if (file) {
+				fail = fail || fwrite(buf.data(), 1, buf.size(), file) != buf.size();
+			}
+			else {
+				fail = fail || !stream->write(buf.data(), buf.size());
+			}
+			buf.clear();
+		}
 
-						if (key) {
-							nestedUT[braceNum]->add_user_type(pool, key, string_buf, type == simdjson::internal::tape_type::START_OBJECT ? 0 : 1); // object vs array
-							key = nullptr; ++pool;
-						}
-						else {
-							nestedUT[braceNum]->add_user_type(pool, type == simdjson::internal::tape_type::START_OBJECT ? 0 : 1);
-							++pool;
-						}
+		bool good() const {
+			return !fail;
+		}
 
+		// not flushed part, all if no sink.
+		std::string& str() {
+			return buf;
+		}
+	};
 
-						class UserType* pTemp = nestedUT[braceNum]->get_data_list(nestedUT[braceNum]->get_data_size() - 1);
+	// sizes of parts of containers split by parallel LoadData::_save, see LoadData::_measure
+	using PartSize = std::unordered_map<const UserType*, std::vector<size_t>>;
 
-						pTemp->reserve_data_list(((payload >> 32) & simdjson::internal::JSON_COUNT_MASK));
-					
-						braceNum++;
+	// counts bytes of LoadData::_save, no output.
+	class CountWriter {
+	public:
+		size_t size = 0;
+		PartSize* part_size = nullptr; // not nullptr -> sizes of parts are kept.
 
-						/// new nestedUT
-						if (nestedUT.size() == braceNum) {
-							nestedUT.push_back(nullptr);
-						}
+		void push_back(char) {
+			++size;
+		}
 
-						/// initial new nestedUT.
-						nestedUT[braceNum] = pTemp;
+		void append(const char*, size_t len) {
+			size += len;
+		}
+	};
 
-						state = 0;
+	// writes LoadData::_save into buffer of measured size, no check.
+	class SpanWriter {
+	public:
+		char* ptr = nullptr;
+		const PartSize* part_size = nullptr; // of LoadData::_measure with same thr_num, or parts are counted again.
 
-					}
-					
-					break;
-					// Right 2
-					case simdjson::internal::tape_type::END_OBJECT:
-					case simdjson::internal::tape_type::END_ARRAY:
-					{
+		void push_back(char c) {
+			*ptr = c;
+			++ptr;
+		}
 
-						state = 0;
+		void append(const char* str, size_t len) {
+			std::memcpy(ptr, str, len);
+			ptr += len;
+		}
+	};
 
-						if (!Vec.empty()) {
-							if (type == simdjson::internal::tape_type::END_OBJECT) {
-								nestedUT[braceNum]->reserve_data_list(nestedUT[braceNum]->get_data_size() + Vec.size() / 2);
+	// index of first byte of str[i, size) which needs escape ( '"', '\\', < 0x20 ), or size.
+	inline size_t FindEscape(std::string_view str, size_t i) {
+		const unsigned char* p = reinterpret_cast<const unsigned char*>(str.data());
+		const size_t size = str.size();
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		const __m128i control = _mm_set1_epi8(0x1F);
+
+		for (; i + 16 <= size; i += 16) {
+			const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+			const __m128i mask = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, backslash)),
+				_mm_cmpeq_epi8(_mm_max_epu8(x, control), control)); // x <= 0x1F
+			const int bits = _mm_movemask_epi8(mask);
+			if (bits) {
+#ifdef _MSC_VER
+				unsigned long idx;
+				_BitScanForward(&idx, bits);
+				return i + idx;
+#else
+				return i + __builtin_ctz(bits);
+#endif
+			}
+		}
+#endif
+		for (; i < size; ++i) {
+			if (p[i] < 0x20 || p[i] == '"' || p[i] == '\\') {
+				break;
+			}
+		}
+		return i;
+	}
+
+	// "str" with JSON escapes, clean runs are appended at once. Out : std::string or Writer.
+	template <class Out>
+	inline void EscapeString(Out& out, std::string_view str) {
+		static const char hex[] = "0123456789abcdef";
+		size_t run = 0;
+
+		out.push_back('"');
+		for (size_t i = FindEscape(str, 0); i < str.size(); i = FindEscape(str, i + 1)) {
+			const unsigned char c = str[i];
+
+			out.append(str.data() + run, i - run);
+			run = i + 1;
+
+			switch (c) {
+			case '"': out.append("\\\"", 2); break;
+			case '\\': out.append("\\\\", 2); break;
+			case '\b': out.append("\\b", 2); break;
+			case '\f': out.append("\\f", 2); break;
+			case '\n': out.append("\\n", 2); break;
+			case '\r': out.append("\\r", 2); break;
+			case '\t': out.append("\\t", 2); break;
+			default:
+			{
+				const char code[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+				out.append(code, 6);
+			}
+			break;
+			}
+		}
+		out.append(str.data() + run, str.size() - run);
+		out.push_back('"');
+	}
+
+	// layouts of LoadData::_save, chosen at compile time.
+	//  depth of item : depth of its container + 1, the top-level value is at 0.
+
+	// " { \n", " : ", ", "  ( default, as before )
+	class LegacyLayout {
+	public:
+		static constexpr bool copy_source = false;
+
+		template <class Out> void open(Out& out, bool is_object, bool after_key) const {
+			out.append(after_key ? (is_object ? "  { \n" : "  [ \n") : (is_object ? " { \n" : " [ \n"), after_key ? 5 : 4);
+		}
+		template <class Out> void close(Out& out, bool is_object, bool /*empty*/, int /*depth*/) const {
+			out.append(is_object ? " } \n" : " ] \n", 4);
+		}
+		template <class Out> void item(Out& /*out*/, int /*depth*/) const { }
+		template <class Out> void key_end(Out& out) const { out.append(" : ", 3); }
+		template <class Out> void array_item_end(Out& out) const { out.push_back(' '); }
+		template <class Out> void comma(Out& out) const { out.append(", ", 2); }
+		template <class Out> void null(Out& out) const { out.append("null ", 5); }
+	};
+
+	// no whitespace.
+	class CompactLayout {
+	public:
+		static constexpr bool copy_source = false;
+
+		template <class Out> void open(Out& out, bool is_object, bool /*after_key*/) const { out.push_back(is_object ? '{' : '['); }
+		template <class Out> void close(Out& out, bool is_object, bool /*empty*/, int /*depth*/) const { out.push_back(is_object ? '}' : ']'); }
+		template <class Out> void item(Out& /*out*/, int /*depth*/) const { }
+		template <class Out> void key_end(Out& out) const { out.push_back(':'); }
+		template <class Out> void array_item_end(Out& /*out*/) const { }
+		template <class Out> void comma(Out& out) const { out.push_back(','); }
+		template <class Out> void null(Out& out) const { out.append("null", 4); }
+	};
+
+	// one item per line, indent * depth spaces. ( "\n" + spaces are kept in one string )
+	class PrettyLayout {
+	private:
+		std::string line;
+		int indent;
+	public:
+		static constexpr bool copy_source = false;
+
+		explicit PrettyLayout(int indent = 2, int max_depth = 64) : indent(indent < 0 ? 0 : indent) {
+			line.assign(1 + (size_t)this->indent * (max_depth < 1 ? 1 : max_depth), ' ');
+			line[0] = '\n';
+		}
+
+		template <class Out> void open(Out& out, bool is_object, bool /*after_key*/) const { out.push_back(is_object ? '{' : '['); }
+		template <class Out> void close(Out& out, bool is_object, bool empty, int depth) const {
+			if (!empty) {
+				new_line(out, depth);
+			}
+			out.push_back(is_object ? '}' : ']');
+		}
+		template <class Out> void item(Out& out, int depth) const {
+			if (depth > 0) {
+				new_line(out, depth);
+			}
+		}
+		template <class Out> void key_end(Out& out) const { out.append(": ", 2); }
+		template <class Out> void array_item_end(Out& /*out*/) const { }
+		template <class Out> void comma(Out& out) const { out.push_back(','); }
+		template <class Out> void null(Out& out) const { out.append("null", 4); }
+	private:
+		template <class Out> void new_line(Out& out, int depth) const {
+			size_t len = (size_t)indent * depth;
+			if (len < line.size()) {
+				out.append(line.data(), len + 1);
+				return;
+			}
+			out.append(line.data(), line.size()); // deeper than max_depth
+			for (len -= line.size() - 1; len > 0; ) {
+				const size_t n = std::min(len, line.size() - 1);
+				out.append(line.data() + 1, n);
+				len -= n;
+			}
+		}
+	};
+
+	// clean subtrees are copied from SourceText as is, others are saved by Base.
+	template <class Base = CompactLayout>
+	class SourceLayout : public Base {
+	public:
+		static constexpr bool copy_source = true;
+
+		const SourceText* source;
+
+		explicit SourceLayout(const SourceText& source, const Base& base = Base()) : Base(base), source(&source) { }
+	};
+
+	class LoadData
+	{
+	public:
+		// ut_rest - if not nullptr and returns -1, the first node of ut side which has no pair in next side.
+		static int Merge(class UserType* next, class UserType* ut, class UserType** ut_next, class UserType** ut_rest = nullptr, int thr_num = 1)
+		{
+
+			// check!!
+			while (ut->get_data_size() >= 1
+				&& (ut->get_data_list(0)->is_user_type()) && (ut->get_data_list(0))->is_virtual())
+			{
+				ut = (UserType*)ut->get_data_list(0);
+			}
+
+			bool chk_ut_next = false;
+
+			while (true) {
+
+				class UserType* _ut = ut;
+				class UserType* _next = next;
+
+
+				if (ut_next && _ut == *ut_next) {
+					*ut_next = _next;
+					chk_ut_next = true;
+				}
+
+				// only first child can be virtual. (already merged)
+				size_t first = 0;
+				if (_ut->get_data_size() > 0 && _ut->get_data_list(0)->is_user_type() && _ut->get_data_list(0)->is_virtual()) {
+					first = 1;
+				}
+
+				_next->AdoptChildren(_ut, first, thr_num);
+
+				_ut->remove_all();
+
+				ut = ut->get_parent();
+				next = next->get_parent();
+
+
+				if (next && ut) {
+					//
+				}
+				else {
+					// right_depth > left_depth
+					if (!next && ut) {
+						if (ut_rest) {
+							*ut_rest = ut;
+						}
+						return -1;
+					}
+					else if (next && !ut) {
+						return 1;
+					}
+
+					return 0;
+				}
+			}
+		}
+
+		// merge two adjacent partial trees, left = (root, next), right = (ut, *ut_next).
+		// root - root of left, &_global or virtual root(type -2) of one chunk.
+		// next - right spine end of left, ut - root of right, ut_next - right spine end of right.
+		// right can close more containers than left opened ( -> they are opened before left ),
+		//    then the remained left spine of right becomes left spine of the result.
+		// result = (root, *ut_next), returns -1 if not valid.
+		// thr_num - threads for parent fixups, 1 if other merges run at the same time.
+		static int MergePartial(class UserType* root, class UserType* next, class UserType* ut, class UserType** ut_next, int thr_num)
+		{
+			class UserType* rest = nullptr;
+
+			int err = Merge(next, ut, ut_next, &rest, thr_num);
+
+			if (-1 != err) {
+				return 0;
+			}
+
+			// root is real root(or not virtual root), so no more container to close.
+			if (root->type != -2) {
+				return -1;
+			}
+
+			// rest->get_data_list(0) is virtual and its children were moved to root, (now empty)
+			//  so root`s children are in the virtual.
+			class UserType* level = rest->get_data_list(0);
+
+			level->AdoptChildren(root, 0, thr_num);
+			root->remove_all();
+
+			// ut`s children become root`s children.
+			root->AdoptChildren(ut, 0, thr_num);
+			ut->remove_all();
+
+			if (ut_next && *ut_next == ut) {
+				*ut_next = root;
+			}
+
+			return 0;
+		}
+
+	private:
+		// pool - first slot of this range, after_pool - one past the last used slot.
+		static bool __LoadData(claujson::UserType* pool, const uint8_t* string_buf, const uint64_t* token_arr,
+			int64_t token_arr_start, size_t token_arr_len, class UserType* _global,
+			int start_state, int last_state, class UserType** next, int* err, int no, UserType*& after_pool, bool pack_numeric_array)
+		{
+			int a = clock();
+
+			std::vector<const uint64_t*> Vec;
+
+			if (token_arr_len <= 0) {
+				*next = nullptr;
+				return false;
+			}
+
+			Data tempData;
+
+			class UserType& global = *_global;
+
+			int state = start_state;
+			size_t braceNum = 0;
+			std::vector< class UserType* > nestedUT(1);
+
+			nestedUT.reserve(1024);
+			nestedUT[0] = &global;
+
+			int64_t count = 0;
+
+			const uint64_t* key = nullptr;
+
+			for (int64_t i = 0; i < token_arr_len; ++i) {
+
+				const simdjson::internal::tape_type type =
+					static_cast<simdjson::internal::tape_type>((((token_arr)[token_arr_start + i]) >> 56));
+
+				uint64_t payload = (token_arr[token_arr_start + i]) & simdjson::internal::JSON_VALUE_MASK;
+
+
+				switch (state)
+				{
+				case 0:
+				{
+					// Left 1
+					switch (type) {
+					case simdjson::internal::tape_type::START_OBJECT:
+					case simdjson::internal::tape_type::START_ARRAY:
+					{ // object start, array start
+
+						if (!Vec.empty()) {
+
+							if (static_cast<simdjson::internal::tape_type>((*Vec[0]) >> 56) == simdjson::internal::tape_type::KEY) {
+								nestedUT[braceNum]->reserve_data_list(nestedUT[braceNum]->get_data_size() + Vec.size() / 2);
+								for (size_t x = 0; x < Vec.size(); x += 2) {
+									nestedUT[braceNum]->add_item_type(pool, Vec[x], Vec[x + 1], string_buf);
+									++pool;
+								}
+							}
+							else {
+								nestedUT[braceNum]->reserve_data_list(nestedUT[braceNum]->get_data_size() + Vec.size());
+								for (size_t x = 0; x < Vec.size(); x += 1) {
+									nestedUT[braceNum]->add_item_type(pool, Vec[x], string_buf);
+									++pool;
+								}
+							}
+
+							Vec.clear();
+						}
+
+						if (key) {
+							nestedUT[braceNum]->add_user_type(pool, key, string_buf, type == simdjson::internal::tape_type::START_OBJECT ? 0 : 1); // object vs array
+							key = nullptr; ++pool;
+						}
+						else {
+							nestedUT[braceNum]->add_user_type(pool, type == simdjson::internal::tape_type::START_OBJECT ? 0 : 1);
+							++pool;
+						}
+
+
+						class UserType* pTemp = nestedUT[braceNum]->get_data_list(nestedUT[braceNum]->get_data_size() - 1);
+
+						pTemp->reserve_data_list(((payload >> 32) & simdjson::internal::JSON_COUNT_MASK));
+					
+						braceNum++;
+
+						/// new nestedUT
+						if (nestedUT.size() == braceNum) {
+							nestedUT.push_back(nullptr);
+						}
+
+						/// initial new nestedUT.
+						nestedUT[braceNum] = pTemp;
+
+						state = 0;
+
+					}
+					
+					break;
+					// Right 2
+					case simdjson::internal::tape_type::END_OBJECT:
+					case simdjson::internal::tape_type::END_ARRAY:
+					{
+
+						state = 0;
+
+						if (!Vec.empty()) {
+							if (type == simdjson::internal::tape_type::END_OBJECT) {
+								nestedUT[braceNum]->reserve_data_list(nestedUT[braceNum]->get_data_size() + Vec.size() / 2);
 								for (size_t x = 0; x < Vec.size(); x += 2) {
 									nestedUT[braceNum]->add_item_type(pool, Vec[x], Vec[x + 1], string_buf);
 									++pool;
 
 								}
 							}
+							else if (pack_numeric_array && braceNum > 0 && nestedUT[braceNum]->get_data_size() == 0
+								&& nestedUT[braceNum]->make_packed(Vec)) {
+								// END_ARRAY, packed.
+							}
 							else { // END_ARRAY
 								nestedUT[braceNum]->reserve_data_list(nestedUT[braceNum]->get_data_size() + Vec.size());
 								for (size_t x = 0; x < Vec.size(); x += 1) {
@@ -1106,10 +2440,7 @@ namespace claujson {
 							ut.add_user_type(pool, type == simdjson::internal::tape_type::END_OBJECT ? 2 : 3); // json -> "var_name" = val  
 							++pool;
 
-							for (size_t i = 0; i < nestedUT[braceNum]->get_data_size(); ++i) {
-								ut.get_data_list(0)->add_user_type(nestedUT[braceNum]->get_data_list(i));
-								nestedUT[braceNum]->get_data_list(i) = nullptr;
-							}
+							ut.get_data_list(0)->AdoptChildren(nestedUT[braceNum]);
 
 							nestedUT[braceNum]->remove_all();
 							nestedUT[braceNum]->add_user_type(ut.get_data_list(0));
@@ -1141,7 +2472,7 @@ namespace claujson {
 					default: 
 						{
 
-							uint64_t* data = &token_arr[token_arr_start + i]; // Convert(&(token_arr[token_arr_start + i]), string_buf);
+							const uint64_t* data = &token_arr[token_arr_start + i]; // Convert(&(token_arr[token_arr_start + i]), string_buf);
 
 							if (type == simdjson::internal::tape_type::KEY) {
 								const simdjson::internal::tape_type _type =
@@ -1272,7 +2603,7 @@ namespace claujson {
 			return true;
 		}
 
-		static int64_t FindDivisionPlace(const std::unique_ptr<uint8_t[]>& string_buf, const std::unique_ptr<uint64_t[]>& token_arr, int64_t start, int64_t last)
+		static int64_t FindDivisionPlace(const uint8_t* string_buf, const uint64_t* token_arr, int64_t start, int64_t last)
 		{
 			for (int64_t a = start; a <= last; ++a) {
 				auto& x = token_arr[a];
@@ -1308,43 +2639,157 @@ namespace claujson {
 			}
 			return -1;
 		}
-	public:
 
-		static bool _LoadData(claujson::UserType* pool, class UserType& global, const std::unique_ptr<uint8_t[]>& string_buf, const std::unique_ptr<uint64_t[]>& token_arr, int64_t& length,
-			std::vector<int64_t>& start, int parse_num, std::vector<Block>& blocks) 
+		// array at tape[open] is not empty and has only numbers of one type. ( same rule as UserType::make_packed )
+		static bool IsPackableArray(const uint64_t* token_arr, int64_t open)
 		{
-			const int pivot_num = parse_num - 1;
-			//size_t token_arr_len = length; // size?
+			const int64_t close = int64_t(uint32_t(token_arr[open] & simdjson::internal::JSON_VALUE_MASK)) - 1;
+			if (open + 1 == close) {
+				return false;
+			}
 
-			class UserType* before_next = nullptr;
-			class UserType _global;
+			const simdjson::internal::tape_type type = static_cast<simdjson::internal::tape_type>(token_arr[open + 1] >> 56);
+			if (!PackedArray::is_packable(type)) {
+				return false;
+			}
+			for (int64_t i = open + 1; i < close; i += 2) {
+				if (static_cast<simdjson::internal::tape_type>(token_arr[i] >> 56) != type) {
+					return false;
+				}
+			}
+			return true;
+		}
 
-			bool first = true;
-			int64_t sum = 0;
+		// pack_numeric_array : an array is packed only if it is in one range,
+		//  and FindDivisionPlace can split a numeric array only at its ']'. then divide just after it,
+		//  so packed arrays do not depend on thr_num. -1 if no place before end.
+		static int64_t SkipPackableClose(const uint64_t* token_arr, int64_t pivot, int64_t end)
+		{
+			if (static_cast<simdjson::internal::tape_type>(token_arr[pivot] >> 56) != simdjson::internal::tape_type::END_ARRAY) {
+				return pivot;
+			}
+			if (!IsPackableArray(token_arr, int64_t(uint32_t(token_arr[pivot] & simdjson::internal::JSON_VALUE_MASK)))) {
+				return pivot;
+			}
+			return pivot + 1 < end ? pivot + 1 : -1;
+		}
 
-			{
-				std::set<int64_t> _pivots;
-				std::vector<int64_t> pivots;
-				//const int64_t num = token_arr_len; //
+		// number of pool slots __LoadData uses for tape[start, start + len) with pack_numeric_array.
+		//  same rule as __LoadData : array opened in the range, only numbers of one type -> packed, no slot for elements.
+		static int64_t CountSlots(const uint64_t* token_arr, int64_t start, int64_t len)
+		{
+			class Frame {
+			public:
+				bool is_array;
+				bool packable;
+				simdjson::internal::tape_type type;
+				int64_t n; // scalar values.
+			};
+
+			std::vector<Frame> _stack;
+			int64_t count = 0;
 
-				if (pivot_num > 0) {
-					std::vector<int64_t> pivot;
-					pivots.reserve(pivot_num);
-					pivot.reserve(pivot_num);
+			_stack.reserve(1024);
 
-					pivot.push_back(start[0]);
+			for (int64_t i = start; i < start + len; ++i) {
+				const simdjson::internal::tape_type type = static_cast<simdjson::internal::tape_type>(token_arr[i] >> 56);
 
-					for (int i = 1; i < parse_num; ++i) {
-						pivot.push_back(FindDivisionPlace(string_buf, token_arr, start[i], start[i + 1] - 1));
+				switch ((int)type) {
+				case '{':
+				case '[':
+					if (!_stack.empty()) {
+						_stack.back().packable = false;
 					}
-
-					for (size_t i = 0; i < pivot.size(); ++i) {
-						if (pivot[i] != -1) {
-							_pivots.insert(pivot[i]);
+					++count;
+					_stack.push_back(Frame{ type == simdjson::internal::tape_type::START_ARRAY, true, type, 0 });
+					break;
+				case '}':
+				case ']':
+					if (_stack.empty()) {
+						++count; // virtual container.
+					}
+					else {
+						const Frame& x = _stack.back();
+						if (!(x.is_array && x.packable && x.n > 0 && PackedArray::is_packable(x.type))) {
+							count += x.n;
 						}
+						_stack.pop_back();
 					}
-
-					for (auto& x : _pivots) {
+					break;
+				case 'k':
+					break;
+				default:
+					if (_stack.empty()) {
+						++count;
+					}
+					else {
+						Frame& x = _stack.back();
+						if (x.n == 0) {
+							x.type = type;
+						}
+						else if (x.type != type) {
+							x.packable = false;
+						}
+						++x.n;
+					}
+					if (type == simdjson::internal::tape_type::INT64 || type == simdjson::internal::tape_type::UINT64
+						|| type == simdjson::internal::tape_type::DOUBLE) {
+						++i;
+					}
+					break;
+				}
+			}
+
+			for (auto& x : _stack) {
+				count += x.n;
+			}
+
+			return count;
+		}
+	public:
+
+		// exact_pool != nullptr - pool is ignored, slots are counted first ( CountSlots, needs pack_numeric_array ),
+		//  then *exact_pool = calloc of *pool_size slots. otherwise tape[i] uses pool[i].
+		static bool _LoadData(claujson::UserType* pool, class UserType& global, const uint8_t* string_buf, const uint64_t* token_arr, int64_t& length,
+			std::vector<int64_t>& start, int parse_num, std::vector<Block>& blocks, bool pack_numeric_array = false,
+			claujson::UserType** exact_pool = nullptr, int64_t* pool_size = nullptr)
+		{
+			const int pivot_num = parse_num - 1;
+			//size_t token_arr_len = length; // size?
+
+			class UserType* before_next = nullptr;
+			class UserType _global;
+
+			bool first = true;
+			int64_t sum = 0;
+
+			{
+				std::set<int64_t> _pivots;
+				std::vector<int64_t> pivots;
+				//const int64_t num = token_arr_len; //
+
+				if (pivot_num > 0) {
+					std::vector<int64_t> pivot;
+					pivots.reserve(pivot_num);
+					pivot.reserve(pivot_num);
+
+					pivot.push_back(start[0]);
+
+					for (int i = 1; i < parse_num; ++i) {
+						int64_t x = FindDivisionPlace(string_buf, token_arr, start[i], start[i + 1] - 1);
+						if (pack_numeric_array && x != -1) {
+							x = SkipPackableClose(token_arr, x, length - 1);
+						}
+						pivot.push_back(x);
+					}
+
+					for (size_t i = 0; i < pivot.size(); ++i) {
+						if (pivot[i] != -1) {
+							_pivots.insert(pivot[i]);
+						}
+					}
+
+					for (auto& x : _pivots) {
 						pivots.push_back(x);
 					}
 
@@ -1355,6 +2800,26 @@ namespace claujson {
 					pivots.push_back(length - 1);
 				}
 
+				// thread i uses pool[slot[i], slot[i + 1]).
+				std::vector<int64_t> slot(pivots);
+
+				if (exact_pool) {
+					std::vector<std::future<int64_t>> count_thr(pivots.size() - 1);
+
+					for (size_t i = 0; i < count_thr.size(); ++i) {
+						count_thr[i] = std::async(std::launch::async, CountSlots, std::ref(token_arr), pivots[i], pivots[i + 1] - pivots[i]);
+					}
+
+					slot[0] = 0;
+					for (size_t i = 0; i < count_thr.size(); ++i) {
+						slot[i + 1] = slot[i] + count_thr[i].get();
+					}
+
+					pool = (claujson::UserType*)calloc(slot.back() > 0 ? slot.back() : 1, sizeof(claujson::UserType));
+					*exact_pool = pool;
+					*pool_size = slot.back();
+				}
+
 				std::vector<class UserType*> next(pivots.size() - 1, nullptr);
 				{
 
@@ -1373,15 +2838,15 @@ namespace claujson {
 						int64_t idx = pivots.size() < 2 ? length - 1 : pivots[1] - pivots[0];
 						int64_t _token_arr_len = idx;
 
-						thr[0] = std::async(std::launch::async, __LoadData, pool, std::ref(string_buf), std::ref(token_arr), start[0], _token_arr_len, &__global[0], 0, 0,
-							&next[0], &err[0], 0, std::ref(after_pool[0]));
+						thr[0] = std::async(std::launch::async, __LoadData, pool + slot[0], std::ref(string_buf), std::ref(token_arr), start[0], _token_arr_len, &__global[0], 0, 0,
+							&next[0], &err[0], 0, std::ref(after_pool[0]), pack_numeric_array);
 					}
 
 					for (size_t i = 1; i < pivots.size() - 1; ++i) {
 						int64_t _token_arr_len = pivots[i + 1] - pivots[i];
 
-						thr[i] = std::async(std::launch::async, __LoadData, pool, std::ref(string_buf), std::ref(token_arr), pivots[i], _token_arr_len, &__global[i], 0, 0,
-							&next[i], &err[i], i, std::ref(after_pool[i]));
+						thr[i] = std::async(std::launch::async, __LoadData, pool + slot[i], std::ref(string_buf), std::ref(token_arr), pivots[i], _token_arr_len, &__global[i], 0, 0,
+							&next[i], &err[i], i, std::ref(after_pool[i]), pack_numeric_array);
 					}
 
 
@@ -1393,7 +2858,11 @@ namespace claujson {
 					}
 
 					for (int i = 0; i < pivots.size() - 1; ++i) { // bug fix
-						blocks.push_back(Block{ after_pool[i] - pool, start[i + 1] - (after_pool[i] - pool) });
+						if (!after_pool[i]) {
+							continue;
+						}
+						// slots [after_pool[i], slot[i + 1]) are not used by thread i.
+						blocks.push_back(Block{ after_pool[i] - pool, slot[i + 1] - (after_pool[i] - pool) });
 					}
 
 					auto b = std::chrono::steady_clock::now();
@@ -1470,39 +2939,64 @@ namespace claujson {
 
 
 
-						int err = Merge(&_global, &__global[start], &next[start]);
+						int err = Merge(&_global, &__global[start], &next[start], nullptr, parse_num);
 						if (-1 == err || (pivots.size() == 0 && 1 == err)) {
 							std::cout << "not valid file3\n";
 							throw 3;
 						}
 
-						for (int i = start + 1; i <= last; ++i) {
+						// partial trees, (root[k], next[part[k]]) 
+						std::vector<int> part;
+						std::vector<class UserType*> root;
 
+						for (int i = start; i <= last; ++i) {
 							if (chk[i]) {
 								continue;
 							}
+							part.push_back(i);
+							root.push_back(i == start ? &_global : &__global[i]);
+						}
 
-							// linearly merge and error check...
-							int before = i - 1;
-							for (int k = i - 1; k >= 0; --k) {
-								if (chk[k] == 0) {
-									before = k;
-									break;
-								}
+						// merge adjacent partial trees pairwise, log-depth.
+						for (size_t stride = 1; stride < part.size(); stride *= 2) {
+							std::vector<size_t> left;
+							for (size_t k = 0; k + stride < part.size(); k += 2 * stride) {
+								left.push_back(k);
 							}
 
-							int err = Merge(next[before], &__global[i], &next[i]);
+							std::vector<std::future<int>> merge_thr(left.size());
+							std::vector<int> merge_err(left.size(), 0);
+
+							// parse_num threads in total for this round.
+							const int merge_thr_num = std::max(1, parse_num / int(left.size()));
+
+							for (size_t j = 1; j < left.size(); ++j) {
+								const size_t k = left[j];
+								merge_thr[j] = std::async(std::launch::async, MergePartial, root[k], next[part[k]], root[k + stride], &next[part[k + stride]], merge_thr_num);
+							}
+							merge_err[0] = MergePartial(root[0], next[part[0]], root[stride], &next[part[stride]], merge_thr_num);
 
-							if (-1 == err) {
-								std::cout << "chk " << i << " " << __global.size() << "\n";
-								std::cout << "not valid file4\n";
-								throw 4;
+							for (size_t j = 1; j < left.size(); ++j) {
+								merge_err[j] = merge_thr[j].get();
 							}
-							else if (i == pivots.size() && 1 == err) {
-								std::cout << "not valid file5\n";
-								throw 5;
+
+							for (size_t j = 0; j < left.size(); ++j) {
+								const size_t k = left[j];
+
+								if (-1 == merge_err[j]) {
+									std::cout << "chk " << part[k + stride] << " " << __global.size() << "\n";
+									std::cout << "not valid file4\n";
+									throw 4;
+								}
+
+								next[part[k]] = next[part[k + stride]];
 							}
 						}
+
+						if (next[start] != &_global) {
+							std::cout << "not valid file5\n";
+							throw 5;
+						}
 					}
 					//catch (...) {
 						//throw "in Merge, error";
@@ -1518,537 +3012,5423 @@ namespace claujson {
 			}
 			//int a = clock();
 
-			Merge(&global, &_global, nullptr);
+			Merge(&global, &_global, nullptr, nullptr, parse_num);
 
 			/// global = std::move(_global);
 			//int b = clock();
 			//std::cout << "chk " << b - a << "ms\n";
 			return true;
 		}
-		static bool parse(claujson::UserType* pool, class UserType& global, const std::unique_ptr<uint8_t[]>& string_buf, const std::unique_ptr<uint64_t[]>& tokens,
+		static bool parse(claujson::UserType* pool, class UserType& global, const uint8_t* string_buf, const uint64_t* tokens,
+			int64_t length, std::vector<int64_t>& start, int thr_num, std::vector<Block>& blocks, bool pack_numeric_array = false) {
+			return LoadData::_LoadData(pool, global, string_buf, tokens, length, start, thr_num, blocks, pack_numeric_array);
+		}
+		// pack_numeric_array, pool is allocated here with exact size, elements of packed arrays have no slot.
+		static bool parse_packed(claujson::UserType*& pool, int64_t& pool_size, class UserType& global, const uint8_t* string_buf, const uint64_t* tokens,
 			int64_t length, std::vector<int64_t>& start, int thr_num, std::vector<Block>& blocks) {
-			return LoadData::_LoadData(pool, global, string_buf, tokens, length, start, thr_num, blocks);
+			return LoadData::_LoadData(nullptr, global, string_buf, tokens, length, start, thr_num, blocks, true, &pool, &pool_size);
 		}
 
-		//
-		static void _save(std::ostream& stream, UserType* ut, const int depth = 0) {
-			if (!ut) { return; }
-
-			if (ut->is_object()) {
-				for (size_t i = 0; i < ut->get_data_size(); ++i) {
-					if (ut->get_data_list(i)->is_user_type()) {
-						auto& x = ut->get_data_list(i)->value;
-
-						if (
-							x.key.type == simdjson::internal::tape_type::STRING) {
-							stream << "\"";
-							for (long long j = 0; j < (*x.key.get_str_val()).size(); ++j) {
-								switch ((*x.key.get_str_val())[j]) {
-								case '\\':
-									stream << "\\\\";
-									break;
-								case '\"':
-									stream << "\\\"";
-									break;
-								case '\n':
-									stream << "\\n";
-									break;
-
-								default:
-									if (isprint((*x.key.get_str_val())[j]))
-									{
-										stream << (*x.key.get_str_val())[j];
-									}
-									else
-									{
-										int code = (*x.key.get_str_val())[j];
-										if (code > 0 && (code < 0x20 || code == 0x7F))
-										{
-											char buf[] = "\\uDDDD";
-											sprintf(buf + 2, "%04X", code);
-											stream << buf;
-										}
-										else {
-											stream << (*x.key.get_str_val())[j];
-										}
-									}
-								}
-							}
+		// builds containers down to depth ( top-level value is 0 ), deeper containers are left as tape ranges. ( UserType::is_lazy )
+		//  deeper containers are skipped in O(1) by the jump offset of '{' or '['.
+		// pool == nullptr - only count nodes, returns number of nodes.
+		static int64_t parse_lazy(claujson::UserType* pool, class UserType& global, const uint8_t* string_buf, const uint64_t* token_arr,
+			int64_t length, int depth, bool pack_numeric_array, LazyTape* lazy) {
+			std::vector<class UserType*> nestedUT(1, &global);
+			int64_t count = 0;
+			const uint64_t* key = nullptr;
 
-							stream << "\"";
+			for (int64_t i = 1; i < length - 1;) {
+				const uint64_t* token = &token_arr[i];
+				const simdjson::internal::tape_type type = static_cast<simdjson::internal::tape_type>((*token) >> 56);
+				const uint64_t payload = (*token) & simdjson::internal::JSON_VALUE_MASK;
 
-							if (x.key.is_key) {
-								stream << " : ";
-							}
+				switch (type) {
+				case simdjson::internal::tape_type::KEY:
+					key = token;
+					++i;
+					break;
+				case simdjson::internal::tape_type::START_OBJECT:
+				case simdjson::internal::tape_type::START_ARRAY:
+				{
+					class UserType* ut = nullptr;
+
+					if (pool) {
+						const int ut_type = type == simdjson::internal::tape_type::START_OBJECT ? 0 : 1;
+						if (key) {
+							nestedUT.back()->add_user_type(pool + count, key, string_buf, ut_type);
 						}
 						else {
-							std::cout << "Error : no key\n";
+							nestedUT.back()->add_user_type(pool + count, ut_type);
 						}
-						stream << " ";
+						ut = pool + count;
+					}
+					++count;
+					key = nullptr;
 
-						if (((UserType*)ut->get_data_list(i))->is_object()) {
-							stream << " { \n";
+					if (int64_t(nestedUT.size()) - 1 > depth) {
+						if (ut) {
+							ut->lazy = lazy;
+							ut->tape_idx = uint32_t(i);
 						}
-						else {
-							stream << " [ \n";
+						i = uint32_t(payload); // next of '}' or ']'
+					}
+					else if (pack_numeric_array && type == simdjson::internal::tape_type::START_ARRAY && IsPackableArray(token_arr, i)) {
+						if (ut) {
+							std::vector<const uint64_t*> tokens;
+							tokens.reserve((payload >> 32) & simdjson::internal::JSON_COUNT_MASK);
+							for (int64_t j = i + 1; j < int64_t(uint32_t(payload)) - 1; j += 2) {
+								tokens.push_back(&token_arr[j]);
+							}
+							ut->make_packed(tokens);
 						}
-
-						_save(stream, (UserType*)ut->get_data_list(i), depth + 1);
-
-						if (((UserType*)ut->get_data_list(i))->is_object()) {
-							stream << " } \n";
+						i = uint32_t(payload);
+					}
+					else {
+						if (ut) {
+							ut->reserve_data_list(((payload >> 32) & simdjson::internal::JSON_COUNT_MASK));
+						}
+						nestedUT.push_back(ut);
+						++i;
+					}
+				}
+				break;
+				case simdjson::internal::tape_type::END_OBJECT:
+				case simdjson::internal::tape_type::END_ARRAY:
+					nestedUT.pop_back();
+					++i;
+					break;
+				default:
+					if (pool) {
+						if (key) {
+							nestedUT.back()->add_item_type(pool + count, key, token, string_buf);
 						}
 						else {
-							stream << " ] \n";
+							nestedUT.back()->add_item_type(pool + count, token, string_buf);
 						}
 					}
-					else {
-						auto& x = ut->get_data_list(i)->value;
-
-						if (x.key.type == simdjson::internal::tape_type::STRING) {
-							stream << "\"";
-							for (long long j = 0; j < (*x.key.get_str_val()).size(); ++j) {
-								switch ((*x.key.get_str_val())[j]) {
-								case '\\':
-									stream << "\\\\";
-									break;
-								case '\"':
-									stream << "\\\"";
-									break;
-								case '\n':
-									stream << "\\n";
-									break;
-
-								default:
-									if (isprint((*x.key.get_str_val())[j]))
-									{
-										stream << (*x.key.get_str_val())[j];
-									}
-									else
-									{
-										int code = (*x.key.get_str_val())[j];
-										if (code > 0 && (code < 0x20 || code == 0x7F))
-										{
-											char buf[] = "\\uDDDD";
-											sprintf(buf + 2, "%04X", code);
-											stream << buf;
-										}
-										else {
-											stream << (*x.key.get_str_val())[j];
-										}
-									}
-								}
-							}
+					++count;
+					key = nullptr;
 
-							stream << "\"";
+					switch (type) {
+					case simdjson::internal::tape_type::INT64:
+					case simdjson::internal::tape_type::UINT64:
+					case simdjson::internal::tape_type::DOUBLE:
+						i += 2;
+						break;
+					default:
+						++i;
+						break;
+					}
+					break;
+				}
+			}
 
-							if (x.key.is_key) {
-								stream << " : ";
-							}
-						}
+			return count;
+		}
 
-						{
-							auto& x = ut->get_data_list(i)->value;
-
-							if (x.data.type == simdjson::internal::tape_type::STRING) {
-								stream << "\"";
-								for (long long j = 0; j < (*x.data.get_str_val()).size(); ++j) {
-									switch ((*x.data.get_str_val())[j]) {
-									case '\\':
-										stream << "\\\\";
-										break;
-									case '\"':
-										stream << "\\\"";
-										break;
-									case '\n':
-										stream << "\\n";
-										break;
-
-									default:
-										if (isprint((*x.data.get_str_val())[j]))
-										{
-											stream << (*x.data.get_str_val())[j];
-										}
-										else
-										{
-											int code = (*x.data.get_str_val())[j];
-											if (code > 0 && (code < 0x20 || code == 0x7F))
-											{
-												char buf[] = "\\uDDDD";
-												sprintf(buf + 2, "%04X", code);
-												stream << buf;
-											}
-											else {
-												stream << (*x.data.get_str_val())[j];
-											}
-										}
-									}
-								}
+		// builds container at tape[open] ( to its '}' or ']' ) into pool, returns it ( no key, no parent ) or nullptr.
+		//  pool[i - open] is for tape[i], pool has ( close - open + 1 ) slots.
+		//  large subtree uses parallel _LoadData, then not used slots are added to blocks ( relative to pool ).
+		static class UserType* load_subtree(claujson::UserType* pool, const uint8_t* string_buf, const uint64_t* tape,
+			int64_t open, int thr_num, bool pack_numeric_array, std::vector<Block>& blocks) {
+			const int64_t close = int64_t(uint32_t(tape[open] & simdjson::internal::JSON_VALUE_MASK)) - 1; // '}' or ']'
+			const int64_t len = close - open + 1;
+			const int64_t min_len = 1 << 16;
 
-								stream << "\"";
+			class UserType* base = pool - open;
+			class UserType global;
 
-							}
-							else if (x.data.type == simdjson::internal::tape_type::TRUE_VALUE) {
-								stream << "true";
-							}
-							else if (x.data.type == simdjson::internal::tape_type::FALSE_VALUE) {
-								stream << "false";
-							}
-							else if (x.data.type == simdjson::internal::tape_type::DOUBLE) {
-								stream << std::fixed << std::setprecision(6) << (x.data.float_val);
-							}
-							else if (x.data.type == simdjson::internal::tape_type::INT64) {
-								stream << x.data.int_val;
-							}
-							else if (x.data.type == simdjson::internal::tape_type::UINT64) {
-								stream << x.data.uint_val;
-							}
-							else if (x.data.type == simdjson::internal::tape_type::NULL_VALUE) {
-								stream << "null ";
-							}
-						}
-					}
+			if (thr_num > len / min_len) {
+				thr_num = int(len / min_len);
+			}
+
+			if (thr_num <= 1) {
+				class UserType* next = nullptr;
+				class UserType* after_pool = nullptr;
+				int err = 0;
+
+				global.type = -2;
+				if (!__LoadData(pool, string_buf, tape, open, len, &global, 0, 0, &next, &err, 0, after_pool, pack_numeric_array)) {
+					return nullptr;
+				}
+				if (after_pool && after_pool < pool + len) {
+					blocks.push_back(Block{ after_pool - pool, len - (after_pool - pool) });
+				}
+			}
+			else {
+				std::vector<int64_t> start(thr_num + 1, 0);
+				std::vector<Block> _blocks;
 
-					if (i < ut->get_data_size() - 1) {
-						stream << ", ";
+				start[0] = open;
+				for (int i = 1; i < thr_num; ++i) {
+					start[i] = open + len / thr_num * i;
+				}
+				start[thr_num] = close + 1;
+
+				int64_t length = close + 2; // as if tape[close + 1] is 'r'.
+				if (!_LoadData(base, global, string_buf, tape, length, start, thr_num, _blocks, pack_numeric_array)) {
+					return nullptr;
+				}
+				for (size_t i = 0; i < _blocks.size(); ++i) {
+					if (_blocks[i].size > 0) {
+						blocks.push_back(Block{ _blocks[i].start - open, _blocks[i].size });
 					}
 				}
 			}
-			else if (ut->is_array()) {
-				for (size_t i = 0; i < ut->get_data_size(); ++i) {
-					if (ut->get_data_list(i)->is_user_type()) {
 
+			if (global.data.size() != 1) {
+				return nullptr;
+			}
 
-						if (((UserType*)ut->get_data_list(i))->is_object()) {
-							stream << " { \n";
-						}
-						else {
-							stream << " [ \n";
-						}
+			class UserType* result = global.data[0];
+			global.data.clear();
+			return result;
+		}
 
+		// span of containers in text of tape -> source.span, containers under global are clean.
+		//  structural indexes of parser are used, so just after parse.
+		static void set_source(class UserType* global, const uint64_t* tape, int64_t length,
+			const simdjson::dom::parser& parser, SourceText& source) {
+			const uint32_t* idx = parser.implementation->structural_indexes.get();
+			const char* buf = source.json.data();
 
-						_save(stream, (UserType*)ut->get_data_list(i), depth + 1);
+			source.span.assign(length, 0);
 
-						if (((UserType*)ut->get_data_list(i))->is_object()) {
-							stream << " } \n";
-						}
-						else {
-							stream << " ] \n";
-						}
-					}
-					else {
+			uint32_t s = 0;
+			for (int64_t i = 1; i < length - 1; ++i, ++s) {
+				while (buf[idx[s]] == ':' || buf[idx[s]] == ',') { // no tape entry.
+					++s;
+				}
 
-						auto& x = ut->get_data_list(i)->value;
-
-						if (
-							x.data.type == simdjson::internal::tape_type::STRING) {
-							stream << "\"";
-							for (long long j = 0; j < (*x.data.get_str_val()).size(); ++j) {
-								switch ((*x.data.get_str_val())[j]) {
-								case '\\':
-									stream << "\\\\";
-									break;
-								case '\"':
-									stream << "\\\"";
-									break;
-								case '\n':
-									stream << "\\n";
-									break;
-
-								default:
-									if (isprint((*x.data.get_str_val())[j]))
-									{
-										stream << (*x.data.get_str_val())[j];
-									}
-									else
-									{
-										int code = (*x.data.get_str_val())[j];
-										if (code > 0 && (code < 0x20 || code == 0x7F))
-										{
-											char buf[] = "\\uDDDD";
-											sprintf(buf + 2, "%04X", code);
-											stream << buf;
-										}
-										else {
-											stream << (*x.data.get_str_val())[j];
-										}
-									}
-								}
-							}
+				switch (tape[i] >> 56) {
+				case '{':
+				case '[':
+					source.span[i] = idx[s];
+					break;
+				case '}':
+				case ']':
+					source.span[uint32_t(tape[i])] |= uint64_t(idx[s] + 1) << 32; // payload : index of '{' or '['
+					break;
+				case 'l':
+				case 'u':
+				case 'd':
+					++i;
+					break;
+				}
+			}
 
-							stream << "\"";
-						}
-						else if (x.data.type == simdjson::internal::tape_type::TRUE_VALUE) {
-							stream << "true";
-						}
-						else if (x.data.type == simdjson::internal::tape_type::FALSE_VALUE) {
-							stream << "false";
-						}
-						else if (x.data.type == simdjson::internal::tape_type::DOUBLE) {
-							stream << std::fixed << std::setprecision(6) << (x.data.float_val);
-						}
-						else if (x.data.type == simdjson::internal::tape_type::INT64) {
-							stream << x.data.int_val;
-						}
-						else if (x.data.type == simdjson::internal::tape_type::UINT64) {
-							stream << x.data.uint_val;
-						}
-						else if (x.data.type == simdjson::internal::tape_type::NULL_VALUE) {
-							stream << "null ";
-						}
+			// containers in preorder are in order of '{' and '[' in tape.
+			std::vector<class UserType*> stack(global->data.rbegin(), global->data.rend());
+			int64_t i = 1;
 
+			while (!stack.empty()) {
+				class UserType* ut = stack.back();
+				stack.pop_back();
 
-						stream << " ";
-					}
+				if (!ut->is_user_type()) {
+					continue;
+				}
 
-					if (i < ut->get_data_size() - 1) {
-						stream << ", ";
+				for (;; ++i) {
+					const uint64_t type = tape[i] >> 56;
+					if (type == '{' || type == '[') {
+						break;
+					}
+					if (type == 'l' || type == 'u' || type == 'd') {
+						++i;
 					}
 				}
+
+				ut->tape_idx = uint32_t(i);
+				ut->clean = true;
+				++i;
+
+				stack.insert(stack.end(), ut->data.rbegin(), ut->data.rend());
 			}
 		}
 
-		static void save(const std::string& fileName, class UserType& global) {
-			std::ofstream outFile;
-			outFile.open(fileName, std::ios::binary); // binary!
+		// lazy ut -> ut with children, subtree is in tape[ut->tape_idx, end of it].
+		static bool expand(LazyTape* lazy, class UserType* ut) {
+			const uint64_t* tape = lazy->parser->raw_tape().get();
+			const uint8_t* string_buf = lazy->parser->raw_string_buf().get();
 
-			_save(outFile, &global);
+			const int64_t open = ut->tape_idx;
+			const int64_t len = int64_t(uint32_t(tape[open] & simdjson::internal::JSON_VALUE_MASK)) - open;
 
-			outFile.close();
-		}
-	};
+			std::vector<Block> blocks; // rest slots are not reused.
+			class UserType* result = load_subtree(lazy->AllocPool(len), string_buf, tape, open, lazy->thr_num, lazy->pack_numeric_array, blocks);
+			if (!result) {
+				return false;
+			}
 
-	// Parse <- not thread-safe?
-	inline 	claujson::UserType* Parse(const std::string& fileName, int thr_num, UserType* ut, std::vector<Block>& blocks)
-	{
-		if (thr_num <= 0) {
-			thr_num = std::thread::hardware_concurrency();
-		}
-		if (thr_num <= 0) {
-			thr_num = 1;
+			ut->AdoptChildren(result, 0, lazy->thr_num);
+			std::swap(ut->packed, result->packed);
+
+			return true;
 		}
 
-		claujson::UserType* pool = nullptr;
+	private:
+		class ProjectContext {
+		public:
+			// children [first, last) of one container, counted by a thread.
+			class Group {
+			public:
+				uint64_t first;
+				uint64_t last;
+				uint64_t first_idx;
+				int64_t count;
+			};
+
+			const uint8_t* string_buf;
+			const uint64_t* tape;
+			const Projection& projection;
+			int thr_num;
+			bool pack_numeric_array;
+			std::map<uint64_t, std::vector<Group>> groups; // by tape index of '{' or '['
+			std::vector<Block> blocks; // relative to pool.
+			claujson::UserType* pool = nullptr;
+
+			ProjectContext(const uint8_t* string_buf, const uint64_t* tape, const Projection& projection,
+				int thr_num, bool pack_numeric_array)
+				: string_buf(string_buf), tape(tape), projection(projection), thr_num(thr_num), pack_numeric_array(pack_numeric_array) { }
+		};
 
-		int _ = clock();
+		inline const static int64_t project_min_len = 1 << 16;
+
+		// next value.
+		static uint64_t project_next(const uint64_t* tape, uint64_t i) {
+			switch ((int)(tape[i] >> 56)) {
+			case '{':
+			case '[':
+				return uint32_t(tape[i] & simdjson::internal::JSON_VALUE_MASK);
+			case 'l':
+			case 'u':
+			case 'd':
+				return i + 2;
+			}
+			return i + 1;
+		}
 
-		{
-			static simdjson::dom::parser test; // chk... recycle? and no parallel?
+		static bool project_is_container(const uint64_t* tape, uint64_t i) {
+			const int type = (int)(tape[i] >> 56);
+			return type == '{' || type == '[';
+		}
 
-			auto x = test.load(fileName);
+		// large subtree at end of pointer -> _LoadData, uses close - open + 1 slots.
+		static bool project_is_large(const ProjectContext& ctx, uint64_t open, bool parallel) {
+			return parallel && ctx.thr_num > 1
+				&& int64_t(uint32_t(ctx.tape[open] & simdjson::internal::JSON_VALUE_MASK) - open) >= 2 * project_min_len;
+		}
 
-			if (x.error() != simdjson::error_code::SUCCESS) {
-				std::cout << x.error() << "\n";
+		static uint32_t project_step(const ProjectContext& ctx, uint32_t state, uint64_t key, uint64_t idx) {
+			if (key) {
+				const uint64_t payload = ctx.tape[key] & simdjson::internal::JSON_VALUE_MASK;
+				uint32_t len;
+				std::memcpy(&len, ctx.string_buf + payload, sizeof(uint32_t));
+				return ctx.projection.step(state, std::string_view(reinterpret_cast<const char*>(ctx.string_buf + payload + sizeof(uint32_t)), len));
+			}
+			return ctx.projection.step(state, idx);
+		}
 
-				return nullptr;
+		// number of UserTypes of container at tape[open] and its subtree.
+		static int64_t project_count_all(const ProjectContext& ctx, uint64_t open) {
+			const uint64_t end = uint32_t(ctx.tape[open] & simdjson::internal::JSON_VALUE_MASK);
+			int64_t count = 0;
+			for (uint64_t i = open; i < end; ++i) {
+				switch ((int)(ctx.tape[i] >> 56)) {
+				case 'l':
+				case 'u':
+				case 'd':
+					++count; ++i;
+					break;
+				case '}':
+				case ']':
+				case 'k':
+					break;
+				default:
+					++count;
+					break;
+				}
 			}
+			return count;
+		}
 
-			const auto& tape = test.raw_tape();
-			const auto& string_buf = test.raw_string_buf();
+		// children in tape[first, last), key is 0 in array.
+		static int64_t project_count_range(ProjectContext& ctx, bool is_object, uint64_t first, uint64_t last, uint64_t idx, uint32_t state, bool parallel) {
+			int64_t count = 0;
+			for (uint64_t i = first; i < last; ++idx) {
+				uint64_t key = 0;
+				if (is_object) {
+					key = i; ++i;
+				}
 
+				const uint32_t next = project_step(ctx, state, key, idx);
+				if (next != Projection::npos) {
+					const bool container = project_is_container(ctx.tape, i);
 
-			std::vector<int64_t> start(thr_num + 1, 0);
-			//std::vector<int> key;
-			int64_t length;
-			int a = clock();
+					if (ctx.projection.get_state(next).full) {
+						if (!container) {
+							count += 1;
+						}
+						else if (project_is_large(ctx, i, parallel)) {
+							count += uint32_t(ctx.tape[i] & simdjson::internal::JSON_VALUE_MASK) - i;
+						}
+						else {
+							count += project_count_all(ctx, i);
+						}
+					}
+					else if (container) {
+						count += 1 + project_count(ctx, i, next, parallel);
+					}
+				}
 
-			std::cout << a - _ << "ms\n";
+				i = project_next(ctx.tape, i);
+			}
+			return count;
+		}
 
+		// number of UserTypes in container at tape[open], not itself.
+		//  long container is split into groups, counted in parallel.
+		static int64_t project_count(ProjectContext& ctx, uint64_t open, uint32_t state, bool parallel) {
+			const uint64_t end = uint32_t(ctx.tape[open] & simdjson::internal::JSON_VALUE_MASK);
+			const bool is_object = (ctx.tape[open] >> 56) == '{';
 
-			{
-				uint32_t string_length;
-				size_t tape_idx = 0;
-				uint64_t tape_val = tape[tape_idx];
-				uint8_t type = uint8_t(tape_val >> 56);
-				uint64_t payload;
-				tape_idx++;
-				size_t how_many = 0;
-				if (type == 'r') {
-					how_many = size_t(tape_val & simdjson::internal::JSON_VALUE_MASK);
-					length = how_many;
+			if (!parallel || ctx.thr_num <= 1 || int64_t(end - open) < 2 * project_min_len) {
+				return project_count_range(ctx, is_object, open + 1, end - 1, 0, state, parallel);
+			}
 
-					//key = std::vector<int>(how_many, 0);
+			std::vector<ProjectContext::Group> group;
+			const uint64_t len = end - open;
+			uint64_t idx = 0;
+			for (uint64_t i = open + 1; i < end - 1; ++idx) {
+				if (group.empty() || i >= open + len / ctx.thr_num * group.size()) {
+					if (!group.empty()) {
+						group.back().last = i;
+					}
+					group.push_back(ProjectContext::Group{ i, 0, idx, 0 });
 				}
-				else {
-					// Error: no starting root node?
-					return nullptr;
+				if (is_object) {
+					++i;
 				}
+				i = project_next(ctx.tape, i);
+			}
+			if (group.size() < 2) { // one large child, split in it.
+				return project_count_range(ctx, is_object, open + 1, end - 1, 0, state, parallel);
+			}
+			group.back().last = end - 1;
 
-				start[0] = 1;
-				for (int i = 1; i < thr_num; ++i) {
-					start[i] = how_many / thr_num * i;
-				}
+			std::vector<std::future<int64_t>> thr(group.size());
+			for (size_t k = 1; k < group.size(); ++k) {
+				const ProjectContext::Group& x = group[k];
+				thr[k] = std::async(std::launch::async, project_count_range, std::ref(ctx), is_object, x.first, x.last, x.first_idx, state, false);
+			}
+			group[0].count = project_count_range(ctx, is_object, group[0].first, group[0].last, group[0].first_idx, state, false);
 
-				int c = clock();
+			int64_t count = group[0].count;
+			for (size_t k = 1; k < group.size(); ++k) {
+				group[k].count = thr[k].get();
+				count += group[k].count;
+			}
 
+			ctx.groups[open] = std::move(group);
+			return count;
+		}
 
-				// no l,u,d  any 
-				 // true      true
+		static void project_build_range(ProjectContext& ctx, bool is_object, uint64_t first, uint64_t last, uint64_t idx, uint32_t state,
+			class UserType* ut, class UserType*& pool, bool parallel) {
+			for (uint64_t i = first; i < last; ++idx) {
+				uint64_t key = 0;
+				if (is_object) {
+					key = i; ++i;
+				}
+
+				const uint32_t next = project_step(ctx, state, key, idx);
+				if (next != Projection::npos) {
+					const bool container = project_is_container(ctx.tape, i);
+
+					if (ctx.projection.get_state(next).full) {
+						if (!container) {
+							if (key) {
+								ut->add_item_type(pool, &ctx.tape[key], &ctx.tape[i], ctx.string_buf);
+							}
+							else {
+								ut->add_item_type(pool, &ctx.tape[i], ctx.string_buf);
+							}
+							++pool;
+						}
+						else {
+							const bool large = project_is_large(ctx, i, parallel);
+							const int64_t len = uint32_t(ctx.tape[i] & simdjson::internal::JSON_VALUE_MASK) - i;
+							std::vector<Block> blocks;
+
+							class UserType* result = load_subtree(pool, ctx.string_buf, ctx.tape, i, large ? ctx.thr_num : 1, ctx.pack_numeric_array, blocks);
+							if (!result) {
+								throw "Error in project_build_range";
+							}
+							if (key) {
+								Convert(result->value.key, &ctx.tape[key], true, ctx.string_buf);
+							}
+							ut->add_user_type(result);
+
+							if (large) {
+								for (size_t k = 0; k < blocks.size(); ++k) {
+									ctx.blocks.push_back(Block{ (pool - ctx.pool) + blocks[k].start, blocks[k].size });
+								}
+								pool += len;
+							}
+							else { // used slots.
+								pool += blocks.empty() ? len : blocks[0].start;
+							}
+						}
+					}
+					else if (container) {
+						class UserType* child = pool;
+						const int type = (ctx.tape[i] >> 56) == '{' ? 0 : 1;
+
+						if (key) {
+							ut->add_user_type(pool, &ctx.tape[key], ctx.string_buf, type);
+						}
+						else {
+							ut->add_user_type(pool, type);
+						}
+						++pool;
+
+						project_build(ctx, i, next, child, pool, parallel);
+					}
+				}
+
+				i = project_next(ctx.tape, i);
+			}
+		}
+
+		// children of container at tape[open] -> ut, same groups as project_count.
+		static void project_build(ProjectContext& ctx, uint64_t open, uint32_t state, class UserType* ut, class UserType*& pool, bool parallel) {
+			const uint64_t end = uint32_t(ctx.tape[open] & simdjson::internal::JSON_VALUE_MASK);
+			const bool is_object = (ctx.tape[open] >> 56) == '{';
+
+			auto x = parallel ? ctx.groups.find(open) : ctx.groups.end();
+			if (x == ctx.groups.end()) {
+				project_build_range(ctx, is_object, open + 1, end - 1, 0, state, ut, pool, parallel);
+				return;
+			}
+
+			const std::vector<ProjectContext::Group>& group = x->second;
+			std::vector<class UserType> part(group.size());
+			std::vector<class UserType*> part_start(group.size() + 1);
+			std::vector<class UserType*> part_pool(group.size());
+			std::vector<std::future<void>> thr(group.size());
+
+			part_start[0] = pool;
+			for (size_t k = 0; k < group.size(); ++k) {
+				part_start[k + 1] = part_start[k] + group[k].count;
+				part_pool[k] = part_start[k];
+			}
+
+			for (size_t k = 1; k < group.size(); ++k) {
+				thr[k] = std::async(std::launch::async, project_build_range, std::ref(ctx), is_object, group[k].first, group[k].last, group[k].first_idx, state,
+					&part[k], std::ref(part_pool[k]), false);
+			}
+			project_build_range(ctx, is_object, group[0].first, group[0].last, group[0].first_idx, state, &part[0], part_pool[0], false);
+			for (size_t k = 1; k < group.size(); ++k) {
+				thr[k].get();
+			}
+
+			ut->reserve_data_list(ut->data.size() + [&]() { size_t sum = 0; for (auto& y : part) { sum += y.data.size(); } return sum; }());
+			for (size_t k = 0; k < group.size(); ++k) {
+				ut->AdoptChildren(&part[k], 0, ctx.thr_num);
+
+				if (part_pool[k] < part_start[k + 1]) { // packed arrays use less.
+					ctx.blocks.push_back(Block{ part_pool[k] - ctx.pool, part_start[k + 1] - part_pool[k] });
+				}
+			}
+
+			pool = part_start.back();
+		}
+
+	public:
+		// builds only nodes matching projection, returns pool ( size is pool_size ), nullptr if error.
+		//  pool is sized by counting retained nodes first, non-matching containers are skipped by jump offset.
+		static claujson::UserType* parse_projected(class UserType& global, const uint8_t* string_buf, const uint64_t* tape,
+			const Projection& projection, int thr_num, bool pack_numeric_array, int64_t& pool_size, std::vector<Block>& blocks) {
+			ProjectContext ctx(string_buf, tape, projection, thr_num, pack_numeric_array);
+
+			const bool container = project_is_container(tape, 1);
+
+			pool_size = container ? 1 + project_count(ctx, 1, 0, true) : 0;
+
+			ctx.pool = (claujson::UserType*)calloc(pool_size > 0 ? pool_size : 1, sizeof(claujson::UserType));
+			if (!ctx.pool) {
+				return nullptr;
+			}
+
+			if (container) {
+				class UserType* pool = ctx.pool;
+
+				global.add_user_type(pool, (tape[1] >> 56) == '{' ? 0 : 1);
+				++pool;
+
+				project_build(ctx, 1, 0, global.data[0], pool, true);
+
+				if (pool < ctx.pool + pool_size) {
+					ctx.blocks.push_back(Block{ pool - ctx.pool, pool_size - (pool - ctx.pool) });
+				}
+			}
+
+			for (size_t i = 0; i < ctx.blocks.size(); ++i) {
+				blocks.push_back(ctx.blocks[i]);
+			}
+
+			return ctx.pool;
+		}
+
+		// "key" : 
+		template <class Out, class Layout>
+		static void _save_key(Out& out, const Data& key, const Layout& layout) {
+			EscapeString(out, *key.get_str_val());
+
+			if (key.is_key) {
+				layout.key_end(out);
+			}
+		}
+
+		template <class Out, class Layout>
+		static void _save_data(Out& out, const Data& data, const Layout& layout) {
+			char buf[64];
+
+			switch (data.type) {
+			case simdjson::internal::tape_type::STRING:
+				EscapeString(out, *data.get_str_val());
+				break;
+			case simdjson::internal::tape_type::TRUE_VALUE:
+				out.append("true", 4);
+				break;
+			case simdjson::internal::tape_type::FALSE_VALUE:
+				out.append("false", 5);
+				break;
+			case simdjson::internal::tape_type::DOUBLE:
+				out.append(buf, FormatDouble(buf, data.float_val));
+				break;
+			case simdjson::internal::tape_type::INT64:
+				out.append(buf, FormatInt64(buf, data.int_val));
+				break;
+			case simdjson::internal::tape_type::UINT64:
+				out.append(buf, FormatUInt64(buf, data.uint_val));
+				break;
+			case simdjson::internal::tape_type::NULL_VALUE:
+				layout.null(out);
+				break;
+			default:
+				break;
+			}
+		}
+
+		template <class Out, class Layout>
+		static void _save_packed(Out& out, UserType* ut, const Layout& layout, const int depth) {
+			for (size_t i = 0; i < ut->get_packed_size(); ++i) {
+				char buf[64];
+
+				layout.item(out, depth);
+
+				switch (ut->get_packed_type()) {
+				case simdjson::internal::tape_type::DOUBLE:
+					out.append(buf, FormatDouble(buf, ut->get_packed_double()[i]));
+					break;
+				case simdjson::internal::tape_type::INT64:
+					out.append(buf, FormatInt64(buf, ut->get_packed_int64()[i]));
+					break;
+				case simdjson::internal::tape_type::UINT64:
+					out.append(buf, FormatUInt64(buf, ut->get_packed_uint64()[i]));
+					break;
+				default:
+					break;
+				}
+
+				layout.array_item_end(out);
+
+				if (i < ut->get_packed_size() - 1) {
+					layout.comma(out);
+				}
+			}
+		}
+
+		// children [begin, end) of ut, explicit stack, no recursion.
+		//  thr_num > 1 -> containers with at least 2 * thr_num children are saved by _save_split.
+		template <class Out, class Layout>
+		static void _save_range(Out& out, UserType* ut, const Layout& layout, const int depth, size_t begin, size_t end, const int thr_num) {
+			class Frame {
+			public:
+				UserType* ut;
+				size_t i;
+				size_t end;
+				size_t size;
+				int depth;
+			};
+
+			std::vector<Frame> _stack;
+			_stack.push_back(Frame{ ut, begin, end, ut->get_child_size(), depth });
+
+			// end of container child of _stack.back()
+			auto close = [&out, &layout, &_stack](UserType* child) {
+				const Frame& parent = _stack.back();
+
+				layout.close(out, child->is_object(), child->get_child_size() == 0 && child->get_packed_size() == 0, parent.depth);
+
+				if (parent.i < parent.size) { // parent.i - 1 : idx of child
+					layout.comma(out);
+				}
+			};
+
+			while (true) {
+				Frame& now = _stack.back();
+
+				if (now.i == now.end) {
+					UserType* done = now.ut;
+					_stack.pop_back();
+
+					if (_stack.empty()) {
+						break;
+					}
+					close(done);
+					continue;
+				}
+
+				const bool is_object = now.ut->is_object();
+				const int now_depth = now.depth;
+				const size_t i = now.i++;
+				const bool last = now.i == now.size;
+
+				auto* child = now.ut->get_data_list(i);
+				auto& x = child->value;
+
+				layout.item(out, now_depth);
+
+				if (is_object) {
+					if (x.key.type == simdjson::internal::tape_type::STRING) {
+						_save_key(out, x.key, layout);
+					}
+					else if (child->is_user_type()) {
+						std::cout << "Error : no key\n";
+					}
+				}
+
+				if (child->is_user_type()) {
+					if constexpr (Layout::copy_source) {
+						if (child->clean) {
+							const std::string_view text = layout.source->get(child->tape_idx);
+							out.append(text.data(), text.size());
+
+							if (!last) {
+								layout.comma(out);
+							}
+							continue;
+						}
+					}
+
+					layout.open(out, child->is_object(), is_object);
+
+					if (child->is_array()) {
+						_save_packed(out, child, layout, now_depth + 1);
+					}
+
+					const size_t size = child->get_child_size();
+
+					if (thr_num > 1 && size >= 2 * (size_t)thr_num) {
+						_save_split(out, child, layout, now_depth + 1, thr_num);
+						close(child);
+					}
+					else {
+						_stack.push_back(Frame{ child, 0, size, size, now_depth + 1 }); // now is not valid.
+					}
+				}
+				else {
+					_save_data(out, x.data, layout);
+
+					if (!is_object) {
+						layout.array_item_end(out);
+					}
+
+					if (!last) {
+						layout.comma(out);
+					}
+				}
+			}
+		}
+
+		// thr_num > 1 -> first containers with at least 2 * thr_num children on each path are split,
+		//  parts are saved in parallel and put in order. ( same output )
+		// Out : Writer - parts are saved into own Writer and appended,
+		//  CountWriter - parts are counted, sizes are kept in part_size,
+		//  SpanWriter - parts are written at offsets from part_size. ( or counted again )
+		// Layout : LegacyLayout, CompactLayout, PrettyLayout, SourceLayout
+		template <class Out, class Layout>
+		static void _save(Out& out, UserType* ut, const Layout& layout, const int depth, const int thr_num) {
+			if (!ut || (!ut->is_object() && !ut->is_array())) { return; }
+
+			if (ut->is_array()) {
+				_save_packed(out, ut, layout, depth);
+			}
+
+			const size_t size = ut->get_child_size();
+
+			if (thr_num <= 1 || size < 2 * (size_t)thr_num) {
+				_save_range(out, ut, layout, depth, 0, size, thr_num);
+				return;
+			}
+
+			_save_split(out, ut, layout, depth, thr_num);
+		}
+
+		// children of ut in thr_num parts, no packed.
+		template <class Out, class Layout>
+		static void _save_split(Out& out, UserType* ut, const Layout& layout, const int depth, const int thr_num) {
+			const size_t size = ut->get_child_size();
+
+			std::vector<size_t> start(thr_num + 1);
+			for (int t = 0; t < thr_num; ++t) {
+				start[t] = size / thr_num * t;
+			}
+			start[thr_num] = size;
+
+			if constexpr (std::is_same_v<Out, Writer>) {
+				std::vector<Writer> part(thr_num - 1);
+				std::vector<std::future<void>> thr(thr_num - 1);
+
+				for (int t = 1; t < thr_num; ++t) {
+					thr[t - 1] = std::async(std::launch::async, [&part, &start, &layout, ut, depth, t]() {
+						_save_range(part[t - 1], ut, layout, depth, start[t], start[t + 1], 1);
+					});
+				}
+
+				_save_range(out, ut, layout, depth, start[0], start[1], 1);
+
+				for (int t = 1; t < thr_num; ++t) {
+					thr[t - 1].get();
+					out.append(part[t - 1]);
+				}
+			}
+			else if constexpr (std::is_same_v<Out, CountWriter>) {
+				std::vector<size_t> part_size(thr_num, 0);
+				_count_parts(ut, layout, depth, start, part_size);
+
+				for (int t = 0; t < thr_num; ++t) {
+					out.size += part_size[t];
+				}
+				if (out.part_size) {
+					(*out.part_size)[ut] = std::move(part_size);
+				}
+			}
+			else {
+				std::vector<size_t> part_size;
+				if (out.part_size && out.part_size->count(ut)) {
+					part_size = out.part_size->at(ut);
+				}
+				else {
+					part_size.resize(thr_num, 0);
+					_count_parts(ut, layout, depth, start, part_size);
+				}
+
+				std::vector<std::future<void>> thr(thr_num - 1);
+				char* ptr = out.ptr + part_size[0];
+
+				for (int t = 1; t < thr_num; ++t) {
+					thr[t - 1] = std::async(std::launch::async, [&start, &layout, ut, depth, t, ptr]() {
+						SpanWriter part{ ptr };
+						_save_range(part, ut, layout, depth, start[t], start[t + 1], 1);
+					});
+					ptr += part_size[t];
+				}
+
+				_save_range(out, ut, layout, depth, start[0], start[1], 1);
+
+				for (int t = 1; t < thr_num; ++t) {
+					thr[t - 1].get();
+				}
+				out.ptr = ptr;
+			}
+		}
+
+		template <class Layout>
+		static void _count_parts(UserType* ut, const Layout& layout, const int depth, const std::vector<size_t>& start, std::vector<size_t>& part_size) {
+			const int thr_num = (int)part_size.size();
+			std::vector<std::future<void>> thr(thr_num - 1);
+
+			for (int t = 1; t < thr_num; ++t) {
+				thr[t - 1] = std::async(std::launch::async, [&start, &part_size, &layout, ut, depth, t]() {
+					CountWriter part;
+					_save_range(part, ut, layout, depth, start[t], start[t + 1], 1);
+					part_size[t] = part.size;
+				});
+			}
+
+			CountWriter part;
+			_save_range(part, ut, layout, depth, start[0], start[1], 1);
+			part_size[0] = part.size;
+
+			for (int t = 1; t < thr_num; ++t) {
+				thr[t - 1].get();
+			}
+		}
+
+		// LegacyLayout
+		template <class Out, std::enable_if_t<!std::is_base_of_v<std::ostream, Out>, int> = 0>
+		static void _save(Out& out, UserType* ut, const int depth = 0, const int thr_num = 1) {
+			_save(out, ut, LegacyLayout(), depth, thr_num);
+		}
+
+		static void _save(std::ostream& stream, UserType* ut, const int depth = 0) {
+			Writer out(stream);
+
+			_save(out, ut, LegacyLayout(), depth, 1);
+		}
+
+		template <class Layout>
+		static void _save(std::ostream& stream, UserType* ut, const Layout& layout) {
+			Writer out(stream);
+
+			_save(out, ut, layout, 0, 1);
+		}
+
+		// exact size of _save(out, ut, layout, depth, thr_num), part_size - if not nullptr, for SpanWriter.
+		template <class Layout = LegacyLayout>
+		static size_t _measure(UserType* ut, const int depth = 0, const int thr_num = 1, PartSize* part_size = nullptr, const Layout& layout = Layout()) {
+			CountWriter out;
+			out.part_size = part_size;
+
+			_save(out, ut, layout, depth, thr_num);
+
+			return out.size;
+		}
+
+		// measure then write, buf is written only if capacity is enough. returns size of output.
+		//  thr_num <= 0 -> all threads.
+		template <class Layout = LegacyLayout>
+		static size_t save_to_buffer(char* buf, size_t capacity, class UserType& global, int thr_num = 1, const Layout& layout = Layout()) {
+			thr_num = _save_thr_num(thr_num);
+
+			PartSize part_size;
+			const size_t size = _measure(&global, 0, thr_num, &part_size, layout);
+
+			if (size <= capacity) {
+				SpanWriter out{ buf, &part_size };
+
+				_save(out, &global, layout, 0, thr_num);
+			}
+			return size;
+		}
+
+		// str is resized once to exact size.
+		template <class Layout = LegacyLayout>
+		static void save_to_string(std::string& str, class UserType& global, int thr_num = 1, const Layout& layout = Layout()) {
+			thr_num = _save_thr_num(thr_num);
+
+			PartSize part_size;
+			str.resize(_measure(&global, 0, thr_num, &part_size, layout));
+
+			SpanWriter out{ str.empty() ? nullptr : &str[0], &part_size };
+
+			_save(out, &global, layout, 0, thr_num);
+		}
+
+		static int _save_thr_num(int thr_num) {
+			if (thr_num <= 0) {
+				thr_num = std::thread::hardware_concurrency();
+			}
+			if (thr_num <= 0) {
+				thr_num = 1;
+			}
+			return thr_num;
+		}
+
+		// thr_num <= 0 -> all threads.
+		template <class Layout = LegacyLayout>
+		static bool save(const std::string& fileName, class UserType& global, int thr_num = 1, const Layout& layout = Layout()) {
+			thr_num = _save_thr_num(thr_num);
+
+			FILE* file = fopen(fileName.c_str(), "wb"); // binary!
+			if (!file) {
+				std::cout << "file open error " << fileName << "\n";
+				return false;
+			}
+
+			bool ok;
+			{
+				Writer out(file);
+
+				_save(out, &global, layout, 0, thr_num);
+
+				out.flush();
+				ok = out.good();
+			}
+
+			return fclose(file) == 0 && ok;
+		}
+
+		// CBOR ( RFC 8949 ), INT64/UINT64 - major 0, 1, DOUBLE - float64, KEY/STRING - text string,
+		//  object/array - map/array of definite length.
+		template <class Out>
+		static void _save_cbor_head(Out& out, uint8_t major, uint64_t x) {
+			char buf[9];
+			int len;
+
+			if (x < 24) {
+				buf[0] = char((major << 5) | x);
+				len = 1;
+			}
+			else if (x <= 0xff) {
+				buf[0] = char((major << 5) | 24);
+				len = 2;
+			}
+			else if (x <= 0xffff) {
+				buf[0] = char((major << 5) | 25);
+				len = 3;
+			}
+			else if (x <= 0xffffffff) {
+				buf[0] = char((major << 5) | 26);
+				len = 5;
+			}
+			else {
+				buf[0] = char((major << 5) | 27);
+				len = 9;
+			}
+			for (int i = len - 1; i >= 1; --i, x >>= 8) { // big endian
+				buf[i] = char(x & 0xff);
+			}
+			out.append(buf, len);
+		}
+
+		template <class Out>
+		static void _save_cbor_string(Out& out, const std::string& str) {
+			_save_cbor_head(out, 3, str.size());
+			out.append(str.data(), str.size());
+		}
+
+		template <class Out>
+		static void _save_cbor_int64(Out& out, int64_t x) {
+			if (x >= 0) {
+				_save_cbor_head(out, 0, uint64_t(x));
+			}
+			else {
+				_save_cbor_head(out, 1, uint64_t(-(x + 1)));
+			}
+		}
+
+		template <class Out>
+		static void _save_cbor_double(Out& out, double x) {
+			uint64_t bits;
+			std::memcpy(&bits, &x, sizeof(bits));
+
+			char buf[9];
+			buf[0] = char(0xfb);
+			for (int i = 8; i >= 1; --i, bits >>= 8) {
+				buf[i] = char(bits & 0xff);
+			}
+			out.append(buf, 9);
+		}
+
+		template <class Out>
+		static void _save_cbor_data(Out& out, const Data& data) {
+			switch (data.type) {
+			case simdjson::internal::tape_type::STRING:
+				_save_cbor_string(out, *data.get_str_val());
+				break;
+			case simdjson::internal::tape_type::TRUE_VALUE:
+				out.push_back(char(0xf5));
+				break;
+			case simdjson::internal::tape_type::FALSE_VALUE:
+				out.push_back(char(0xf4));
+				break;
+			case simdjson::internal::tape_type::DOUBLE:
+				_save_cbor_double(out, data.float_val);
+				break;
+			case simdjson::internal::tape_type::INT64:
+				_save_cbor_int64(out, data.int_val);
+				break;
+			case simdjson::internal::tape_type::UINT64:
+				_save_cbor_head(out, 0, data.uint_val);
+				break;
+			default:
+				out.push_back(char(0xf6)); // null
+				break;
+			}
+		}
+
+		// children of global, explicit stack, no recursion.
+		template <class Out>
+		static void _save_cbor(Out& out, UserType* global) {
+			class Frame {
+			public:
+				UserType* ut;
+				size_t i;
+			};
+			std::vector<Frame> _stack;
+			_stack.push_back(Frame{ global, 0 });
+
+			while (!_stack.empty()) {
+				Frame& top = _stack.back();
+				if (top.i >= top.ut->get_data_size()) {
+					_stack.pop_back();
+					continue;
+				}
+
+				UserType* x = top.ut->get_data_list(top.i);
+				const bool key = top.ut->is_object();
+				++top.i;
+
+				if (key) {
+					_save_cbor_string(out, *x->get_value().key.get_str_val());
+				}
+
+				if (x->is_item_type()) {
+					_save_cbor_data(out, x->get_value().data);
+				}
+				else if (x->is_packed()) {
+					const size_t len = x->get_packed_size();
+					_save_cbor_head(out, 4, len);
+					for (size_t i = 0; i < len; ++i) {
+						switch (x->get_packed_type()) {
+						case simdjson::internal::tape_type::INT64:
+							_save_cbor_int64(out, x->get_packed_int64()[i]);
+							break;
+						case simdjson::internal::tape_type::UINT64:
+							_save_cbor_head(out, 0, x->get_packed_uint64()[i]);
+							break;
+						default:
+							_save_cbor_double(out, x->get_packed_double()[i]);
+							break;
+						}
+					}
+				}
+				else {
+					_save_cbor_head(out, x->is_object() ? 5 : 4, x->get_data_size());
+					_stack.push_back(Frame{ x, 0 }); // top is invalid now.
+				}
+			}
+		}
+
+		static void save_cbor_to_string(std::string& str, class UserType& global) {
+			Writer out;
+			_save_cbor(out, &global);
+			str.swap(out.str());
+		}
+
+		static bool save_cbor(const std::string& fileName, class UserType& global) {
+			FILE* file = fopen(fileName.c_str(), "wb");
+			if (!file) {
+				std::cout << "file open error " << fileName << "\n";
+				return false;
+			}
+
+			bool ok;
+			{
+				Writer out(file);
+
+				_save_cbor(out, &global);
+
+				out.flush();
+				ok = out.good();
+			}
+
+			return fclose(file) == 0 && ok;
+		}
+
+	private:
+		inline const static uint64_t cbor_indefinite = (uint64_t)-1;
+
+		// initial byte and argument, false if broken. arg is cbor_indefinite for info 31.
+		static bool cbor_head(const uint8_t*& p, const uint8_t* end, uint8_t& major, uint8_t& info, uint64_t& arg) {
+			if (p >= end) {
+				return false;
+			}
+			major = *p >> 5;
+			info = *p & 31;
+			++p;
+
+			if (info < 24) {
+				arg = info;
+				return true;
+			}
+			if (info == 31) {
+				arg = cbor_indefinite;
+				return major >= 2 && major <= 5;
+			}
+			if (info > 27) {
+				return false;
+			}
+
+			const int len = 1 << (info - 24);
+			if (end - p < len) {
+				return false;
+			}
+			arg = 0;
+			for (int i = 0; i < len; ++i) {
+				arg = (arg << 8) | p[i];
+			}
+			p += len;
+			return true;
+		}
+
+		static double cbor_half(uint16_t x) {
+			const int exp = (x >> 10) & 0x1f;
+			const int mant = x & 0x3ff;
+			double val;
+			if (exp == 0) {
+				val = std::ldexp(mant, -24);
+			}
+			else if (exp != 31) {
+				val = std::ldexp(mant + 1024, exp - 25);
+			}
+			else {
+				val = mant == 0 ? INFINITY : NAN;
+			}
+			return (x & 0x8000) ? -val : val;
+		}
+
+		// one text string ( or chunks of indefinite one ), str may be nullptr.
+		static bool cbor_text(const uint8_t*& p, const uint8_t* end, uint64_t arg, std::string* str) {
+			if (arg != cbor_indefinite) {
+				if (uint64_t(end - p) < arg) {
+					return false;
+				}
+				if (str) {
+					str->append(reinterpret_cast<const char*>(p), size_t(arg));
+				}
+				p += arg;
+				return true;
+			}
+
+			while (p < end && *p != 0xff) {
+				uint8_t major, info;
+				if (!cbor_head(p, end, major, info, arg) || major != 3 || arg == cbor_indefinite || !cbor_text(p, end, arg, str)) {
+					return false;
+				}
+			}
+			if (p >= end) {
+				return false;
+			}
+			++p; // break
+			return true;
+		}
+
+		// scalar, p is after head. false if not supported.
+		static bool cbor_scalar(const uint8_t*& p, const uint8_t* end, uint8_t major, uint8_t info, uint64_t arg, Data& data) {
+			switch (major) {
+			case 0:
+				if (arg <= uint64_t(INT64_MAX)) { // same with simdjson, 'u' only if out of int64.
+					data.type = simdjson::internal::tape_type::INT64;
+					data.int_val = int64_t(arg);
+				}
+				else {
+					data.type = simdjson::internal::tape_type::UINT64;
+					data.uint_val = arg;
+				}
+				return true;
+			case 1:
+				if (arg <= uint64_t(INT64_MAX)) {
+					data.type = simdjson::internal::tape_type::INT64;
+					data.int_val = -1 - int64_t(arg);
+				}
+				else {
+					data.type = simdjson::internal::tape_type::DOUBLE;
+					data.float_val = -1.0 - double(arg);
+				}
+				return true;
+			case 3:
+			{
+				std::string str;
+				if (!cbor_text(p, end, arg, &str)) {
+					return false;
+				}
+				data.type = simdjson::internal::tape_type::STRING;
+				data.set_str_val(std::move(str));
+			}
+			return true;
+			case 7:
+				break;
+			default:
+				return false;
+			}
+
+			switch (info) { // simple values and floats.
+			case 20:
+				data.type = simdjson::internal::tape_type::FALSE_VALUE;
+				return true;
+			case 21:
+				data.type = simdjson::internal::tape_type::TRUE_VALUE;
+				return true;
+			case 22:
+			case 23: // undefined
+				data.type = simdjson::internal::tape_type::NULL_VALUE;
+				return true;
+			case 25:
+				data.type = simdjson::internal::tape_type::DOUBLE;
+				data.float_val = cbor_half(uint16_t(arg));
+				return true;
+			case 26:
+			{
+				const uint32_t bits = uint32_t(arg);
+				float x;
+				std::memcpy(&x, &bits, sizeof(x));
+				data.type = simdjson::internal::tape_type::DOUBLE;
+				data.float_val = x;
+			}
+			return true;
+			case 27:
+				data.type = simdjson::internal::tape_type::DOUBLE;
+				std::memcpy(&data.float_val, &arg, sizeof(double));
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		// part of top-level array, built by one thread.
+		class CborSplit {
+		public:
+			const uint8_t* p;
+			int64_t node; // pool index of first element.
+			uint64_t first; // index of first element.
+			uint64_t count = 0;
+		};
+
+		inline const static int64_t cbor_min_len = 1 << 16;
+
+		// number of UserTypes, -1 if broken or not supported ( byte string, non-text key ). explicit stack.
+		//  long top-level array of definite length -> split, elements for thr_num threads.
+		static int64_t cbor_count(const uint8_t* p, const uint8_t* end, int thr_num, std::vector<CborSplit>& split) {
+			class Frame {
+			public:
+				uint64_t left;
+				bool is_map;
+			};
+			std::vector<Frame> _stack;
+			_stack.push_back(Frame{ 1, false }); // root has one value.
+
+			int64_t count = 0;
+			uint64_t root_len = 0; // > 0 if split.
+
+			while (!_stack.empty()) {
+				Frame& top = _stack.back();
+				if (top.left == 0) {
+					_stack.pop_back();
+					continue;
+				}
+				if (top.left == cbor_indefinite && p < end && *p == 0xff) {
+					++p;
+					_stack.pop_back();
+					continue;
+				}
+
+				if (root_len > 0 && _stack.size() == 2) {
+					const uint64_t idx = root_len - top.left;
+					if (idx == root_len / thr_num * split.size()) {
+						split.push_back(CborSplit{ p, count, idx });
+					}
+				}
+
+				uint8_t major, info;
+				uint64_t arg;
+
+				if (top.is_map) {
+					if (!cbor_head(p, end, major, info, arg) || major != 3 || !cbor_text(p, end, arg, nullptr)) {
+						return -1;
+					}
+				}
+				if (top.left != cbor_indefinite) {
+					--top.left;
+				}
+
+				do { // tags are ignored.
+					if (!cbor_head(p, end, major, info, arg)) {
+						return -1;
+					}
+				} while (major == 6);
+
+				++count;
+
+				switch (major) {
+				case 0:
+				case 1:
+					break;
+				case 3:
+					if (!cbor_text(p, end, arg, nullptr)) {
+						return -1;
+					}
+					break;
+				case 4:
+				case 5:
+					// at least one byte per item.
+					if (arg != cbor_indefinite && arg > uint64_t(end - p) / (major == 5 ? 2 : 1)) {
+						return -1;
+					}
+					if (_stack.size() == 1 && major == 4 && arg != cbor_indefinite && thr_num > 1 &&
+						arg >= uint64_t(2 * thr_num) && end - p >= cbor_min_len) {
+						root_len = arg;
+					}
+					_stack.push_back(Frame{ arg, major == 5 }); // top is invalid now.
+					break;
+				case 7:
+					if (!(info >= 20 && info <= 23) && !(info >= 25 && info <= 27)) {
+						return -1;
+					}
+					break;
+				default:
+					return -1;
+				}
+			}
+
+			if (p != end) { // trailing bytes.
+				return -1;
+			}
+
+			for (size_t k = 0; k < split.size(); ++k) {
+				split[k].count = (k + 1 < split.size() ? split[k + 1].first : root_len) - split[k].first;
+			}
+			return count;
+		}
+
+		// `left` values at p -> children of ut. input is checked by cbor_count.
+		static void cbor_build(const uint8_t* p, const uint8_t* end, class UserType* ut, uint64_t left, class UserType*& pool) {
+			class Frame {
+			public:
+				class UserType* ut;
+				uint64_t left;
+			};
+			std::vector<Frame> _stack;
+			_stack.push_back(Frame{ ut, left });
+
+			while (!_stack.empty()) {
+				Frame& top = _stack.back();
+				if (top.left == 0) {
+					_stack.pop_back();
+					continue;
+				}
+				if (top.left == cbor_indefinite && *p == 0xff) {
+					++p;
+					_stack.pop_back();
+					continue;
+				}
+				if (top.left != cbor_indefinite) {
+					--top.left;
+				}
+
+				class UserType* parent = top.ut;
+				uint8_t major, info;
+				uint64_t arg;
+
+				Data key;
+				if (parent->is_object()) {
+					std::string str;
+					cbor_head(p, end, major, info, arg);
+					cbor_text(p, end, arg, &str);
+					key.type = simdjson::internal::tape_type::STRING;
+					key.is_key = true;
+					key.set_str_val(std::move(str));
+				}
+
+				do {
+					cbor_head(p, end, major, info, arg);
+				} while (major == 6);
+
+				if (major == 4 || major == 5) {
+					class UserType* child = parent->make_user_type(pool, std::move(key), major == 5 ? 0 : 1);
+					++pool;
+					parent->add_user_type(child);
+
+					if (arg != cbor_indefinite) { // pre-sized.
+						child->reserve_data_list(size_t(arg));
+					}
+					_stack.push_back(Frame{ child, arg }); // top is invalid now.
+				}
+				else {
+					Data data;
+					cbor_scalar(p, end, major, info, arg, data);
+					parent->data.push_back(parent->make_item_type(pool, std::move(key), std::move(data)));
+					++pool;
+				}
+			}
+		}
+
+	public:
+		// FrozenDocument -> children of global, returns pool ( size is pool_size ), nullptr if empty.
+		//  node i ( pre-order ) is pool[i - 1], so nodes are built in parallel without merge. see FrozenDocument::Thaw
+		static claujson::UserType* thaw(class UserType& global, const class FrozenDocument& doc, int thr_num, int64_t& pool_size);
+
+		// CBOR -> children of global, returns pool ( size is pool_size ), nullptr if broken or not supported.
+		//  pool is sized by counting first, elements of long top-level array are built in parallel.
+		static claujson::UserType* parse_cbor(class UserType& global, const uint8_t* data, size_t size, int thr_num, int64_t& pool_size) {
+			const uint8_t* end = data + size;
+			std::vector<CborSplit> split;
+
+			pool_size = cbor_count(data, end, thr_num, split);
+			if (pool_size < 0) {
+				std::cout << "not valid cbor\n";
+				pool_size = 0;
+				return nullptr;
+			}
+
+			claujson::UserType* pool = (claujson::UserType*)calloc(pool_size > 0 ? pool_size : 1, sizeof(claujson::UserType));
+			if (!pool) {
+				return nullptr;
+			}
+			class UserType* x = pool;
+
+			if (split.size() < 2) {
+				cbor_build(data, end, &global, 1, x);
+				return pool;
+			}
+
+			// top-level array, its elements are built in parts and moved to it.
+			global.add_user_type(x, 1);
+			class UserType* root = global.data.back();
+
+			std::vector<class UserType> part(split.size());
+			std::vector<std::future<void>> thr(split.size());
+
+			part[0].reserve_data_list(size_t(split.back().first + split.back().count)); // moved to root first.
+
+			for (size_t k = 1; k < split.size(); ++k) {
+				thr[k] = std::async(std::launch::async, [&, k]() {
+					class UserType* part_pool = pool + split[k].node;
+					part[k].reserve_data_list(size_t(split[k].count));
+					cbor_build(split[k].p, end, &part[k], split[k].count, part_pool);
+				});
+			}
+			x = pool + split[0].node;
+			cbor_build(split[0].p, end, &part[0], split[0].count, x);
+			for (size_t k = 1; k < split.size(); ++k) {
+				thr[k].get();
+			}
+
+			for (size_t k = 0; k < split.size(); ++k) {
+				root->AdoptChildren(&part[k], 0, thr_num);
+			}
+
+			return pool;
+		}
+	};
+
+	// threads reading same lazy node : one expands, others wait on LazyTape::expand_mtx and see lazy == nullptr.
+	inline void UserType::expand() {
+		LazyTape* tape = lazy.load(std::memory_order_acquire);
+		if (!tape) {
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(tape->expand_mtx);
+
+		if (!lazy.load(std::memory_order_relaxed)) { // expanded by other thread.
+			return;
+		}
+
+		if (!LoadData::expand(tape, this)) {
+			throw "Error in expand";
+		}
+
+		lazy.store(nullptr, std::memory_order_release);
+	}
+
+	// sidecar file of Parse ( ParseOption::tape_cache ), has tape and string_buf of simdjson,
+	//  if input file is not changed ( path, size, mtime, hash ), tape is mapped and stage 1, 2 of simdjson are skipped.
+	class TapeCache {
+	public:
+		// identity of input file.
+		class Key {
+		public:
+			std::string path; // absolute
+			uint64_t size = 0;
+			int64_t mtime = 0;
+			uint64_t hash = 0;
+		};
+	private:
+		class Header {
+		public:
+			char magic[8];
+			uint32_t version;
+			uint32_t endian; // 0x01020304
+			uint32_t simdjson_version; // tape format
+			uint32_t path_size;
+			uint64_t size;
+			int64_t mtime;
+			uint64_t hash;
+			uint64_t tape_size; // words
+			uint64_t string_buf_size; // bytes
+			uint64_t file_size;
+		};
+
+		inline static const char magic[8] = { 'C', 'L', 'A', 'U', 'T', 'A', 'P', 'E' };
+		inline static const uint32_t version = 1;
+		inline static const uint32_t simdjson_version = (simdjson::SIMDJSON_VERSION_MAJOR << 16) | (simdjson::SIMDJSON_VERSION_MINOR << 8) | simdjson::SIMDJSON_VERSION_REVISION;
+
+		static uint64_t Align8(uint64_t x) { return (x + 7) & ~uint64_t(7); }
+
+		// sidecar is not trusted, LoadData needs : nested containers with right jump offsets, keys only in objects before a value,
+		//  strings in string_buf, 2-word numbers. one pass over tape, no recursion. ( values themselves are not checked )
+		static bool CheckTape(const uint64_t* tape, uint64_t tape_size, const uint8_t* string_buf, uint64_t string_buf_size) {
+			class Frame {
+			public:
+				uint64_t open;
+				bool is_object;
+				bool after_key;
+			};
+			std::vector<Frame> _stack;
+
+			const uint64_t last = (tape[0] & simdjson::internal::JSON_VALUE_MASK) - 1; // final 'r'
+			if (last == 0 || last >= tape_size || uint8_t(tape[last] >> 56) != 'r' || (tape[last] & simdjson::internal::JSON_VALUE_MASK) != 0) {
+				return false;
+			}
+
+			uint64_t values = 0; // top-level
+			for (uint64_t i = 1; i < last; ++i) {
+				const uint8_t type = uint8_t(tape[i] >> 56);
+				const uint64_t payload = tape[i] & simdjson::internal::JSON_VALUE_MASK;
+				Frame* top = _stack.empty() ? nullptr : &_stack.back();
+
+				if (type == 'k') {
+					if (!top || !top->is_object || top->after_key) {
+						return false;
+					}
+				}
+				else if (type == '}' || type == ']') {
+					if (!top || top->is_object != (type == '}') || top->after_key || payload != top->open ||
+						uint32_t(tape[top->open] & simdjson::internal::JSON_VALUE_MASK) != i + 1) {
+						return false;
+					}
+					_stack.pop_back();
+					if (!_stack.empty()) {
+						_stack.back().after_key = false;
+					}
+					continue;
+				}
+				else if (top ? top->is_object && !top->after_key : values > 0) { // value without key, or second top-level value.
+					return false;
+				}
+
+				switch (type) {
+				case '{':
+				case '[':
+					if (uint32_t(payload) <= i + 1 || uint32_t(payload) > last) {
+						return false;
+					}
+					if (!top) {
+						++values;
+					}
+					_stack.push_back(Frame{ i, type == '{', false });
+					continue;
+				case 'k':
+				case '"':
+				{
+					uint32_t len;
+					if (payload + sizeof(uint32_t) > string_buf_size) {
+						return false;
+					}
+					std::memcpy(&len, string_buf + payload, sizeof(uint32_t));
+					if (payload + sizeof(uint32_t) + len + 1 > string_buf_size) {
+						return false;
+					}
+				}
+				break;
+				case 'l':
+				case 'u':
+				case 'd':
+					if (i + 1 >= last) {
+						return false;
+					}
+					++i;
+					break;
+				case 'n':
+				case 't':
+				case 'f':
+					break;
+				default:
+					return false;
+				}
+
+				if (top) {
+					top->after_key = type == 'k';
+				}
+				else {
+					++values;
+				}
+			}
+
+			return _stack.empty() && values == 1;
+		}
+
+		// 4 lanes, chunks are combined in order, so same result for any thr_num.
+		static uint64_t HashChunk(const uint8_t* data, uint64_t size) {
+			const uint64_t k = 0x9E3779B97F4A7C15ull;
+			uint64_t h[4] = { k, k ^ 1, k ^ 2, k ^ 3 };
+			uint64_t i = 0;
+			for (; i + 32 <= size; i += 32) {
+				for (int j = 0; j < 4; ++j) {
+					uint64_t w;
+					std::memcpy(&w, data + i + j * 8, 8);
+					h[j] = (h[j] ^ w) * 0xff51afd7ed558ccdull;
+					h[j] ^= h[j] >> 29;
+				}
+			}
+			for (int j = 0; i < size; i += 8, j = (j + 1) % 4) {
+				uint64_t w = 0;
+				std::memcpy(&w, data + i, std::min<uint64_t>(8, size - i));
+				h[j] = (h[j] ^ w) * 0xff51afd7ed558ccdull;
+				h[j] ^= h[j] >> 29;
+			}
+			return (h[0] ^ (h[1] * 31) ^ (h[2] * 961) ^ (h[3] * 29791)) * k;
+		}
+	public:
+		static uint64_t Hash(const uint8_t* data, uint64_t size, int thr_num) {
+			const uint64_t chunk_size = 1 << 20;
+			const uint64_t chunk_count = (size + chunk_size - 1) / chunk_size;
+			std::vector<uint64_t> chunk(chunk_count);
+
+			if (thr_num <= 1 || chunk_count < 2) {
+				for (uint64_t i = 0; i < chunk_count; ++i) {
+					chunk[i] = HashChunk(data + i * chunk_size, std::min(chunk_size, size - i * chunk_size));
+				}
+			}
+			else {
+				std::vector<std::future<void>> thr(thr_num);
+				for (int t = 0; t < thr_num; ++t) {
+					thr[t] = std::async(std::launch::async, [&, t]() {
+						for (uint64_t i = t; i < chunk_count; i += thr_num) {
+							chunk[i] = HashChunk(data + i * chunk_size, std::min(chunk_size, size - i * chunk_size));
+						}
+					});
+				}
+				for (int t = 0; t < thr_num; ++t) {
+					thr[t].get();
+				}
+			}
+
+			uint64_t hash = size;
+			for (uint64_t i = 0; i < chunk_count; ++i) {
+				hash = (hash ^ chunk[i]) * 0xff51afd7ed558ccdull;
+				hash ^= hash >> 33;
+			}
+			return hash;
+		}
+
+		static std::string SidecarName(const std::string& fileName) { return fileName + ".tape"; }
+
+		// reads whole file for hash.
+		static bool GetKey(const std::string& fileName, int thr_num, Key& key) {
+			std::error_code error;
+			const std::filesystem::path path(fileName);
+
+			key.path = std::filesystem::absolute(path, error).string();
+			if (error) {
+				return false;
+			}
+			key.size = std::filesystem::file_size(path, error);
+			if (error) {
+				return false;
+			}
+			key.mtime = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+			if (error) {
+				return false;
+			}
+
+			MappedFile file;
+			if (!file.open(fileName) || file.size() != key.size) {
+				return false;
+			}
+			key.hash = Hash(file.data(), file.size(), thr_num);
+			return true;
+		}
+	private:
+		MappedFile file;
+	public:
+		// views of mapped file, valid until close.
+		const uint64_t* tape = nullptr;
+		const uint8_t* string_buf = nullptr;
+
+		TapeCache() { }
+		TapeCache(const TapeCache&) = delete;
+		TapeCache& operator=(const TapeCache&) = delete;
+		~TapeCache() { close(); }
+
+		void close() {
+			tape = nullptr;
+			string_buf = nullptr;
+			file.close();
+		}
+
+		// false - no sidecar, or it is for other file or old.
+		bool load(const std::string& cacheName, const Key& key) {
+			close();
+
+			if (!file.open(cacheName)) {
+				return false;
+			}
+
+			const uint8_t* base = file.data();
+			const uint64_t size = file.size();
+
+			Header header;
+			if (size < sizeof(header)) {
+				file.close();
+				return false;
+			}
+			std::memcpy(&header, base, sizeof(header));
+
+			const uint64_t tape_offset = Align8(sizeof(header)) + Align8(header.path_size);
+			if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version || header.endian != 0x01020304 ||
+				header.simdjson_version != simdjson_version || header.file_size != size ||
+				header.size != key.size || header.mtime != key.mtime || header.hash != key.hash || header.path_size != key.path.size() ||
+				header.tape_size < 2 || header.tape_size > size / sizeof(uint64_t) || header.string_buf_size > size ||
+				tape_offset + Align8(header.tape_size * sizeof(uint64_t)) + Align8(header.string_buf_size) != size ||
+				std::memcmp(base + Align8(sizeof(header)), key.path.data(), key.path.size()) != 0) {
+				file.close();
+				return false;
+			}
+
+			const uint64_t* _tape = reinterpret_cast<const uint64_t*>(base + tape_offset);
+			const uint8_t* _string_buf = base + tape_offset + Align8(header.tape_size * sizeof(uint64_t));
+			if (uint8_t(_tape[0] >> 56) != 'r' || (_tape[0] & simdjson::internal::JSON_VALUE_MASK) + 1 != header.tape_size ||
+				!CheckTape(_tape, header.tape_size, _string_buf, header.string_buf_size)) {
+				file.close();
+				return false;
+			}
+
+			tape = _tape;
+			string_buf = _string_buf;
+			return true;
+		}
+
+		static bool save(const std::string& cacheName, const Key& key, const uint64_t* tape, const uint8_t* string_buf) {
+			Header header;
+			std::memset(&header, 0, sizeof(header));
+			std::memcpy(header.magic, magic, sizeof(magic));
+			header.version = version;
+			header.endian = 0x01020304;
+			header.simdjson_version = simdjson_version;
+			header.path_size = uint32_t(key.path.size());
+			header.size = key.size;
+			header.mtime = key.mtime;
+			header.hash = key.hash;
+			header.tape_size = (tape[0] & simdjson::internal::JSON_VALUE_MASK) + 1;
+
+			// used part of string_buf.
+			for (uint64_t i = 1; i + 1 < header.tape_size; ++i) {
+				switch (uint8_t(tape[i] >> 56)) {
+				case '"':
+				case 'k':
+				{
+					const uint64_t payload = tape[i] & simdjson::internal::JSON_VALUE_MASK;
+					uint32_t len;
+					std::memcpy(&len, string_buf + payload, sizeof(uint32_t));
+					header.string_buf_size = std::max<uint64_t>(header.string_buf_size, payload + sizeof(uint32_t) + len + 1);
+				}
+				break;
+				case 'l':
+				case 'u':
+				case 'd':
+					++i;
+					break;
+				}
+			}
+
+			const std::pair<const void*, uint64_t> section[] = {
+				{ key.path.data(), header.path_size },
+				{ tape, header.tape_size * sizeof(uint64_t) },
+				{ string_buf, header.string_buf_size }
+			};
+
+			header.file_size = Align8(sizeof(header));
+			for (auto& x : section) {
+				header.file_size += Align8(x.second);
+			}
+
+			// written to temp file, then renamed over sidecar. ( other process may have mapped the old one )
+			const std::string tempName = cacheName + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+				uint64_t(std::chrono::steady_clock::now().time_since_epoch().count())) + ".tmp";
+
+			FILE* file = std::fopen(tempName.c_str(), "wb");
+			if (!file) {
+				return false;
+			}
+
+			static const char zero[8] = { 0 };
+			bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+			ok = ok && std::fwrite(zero, 1, Align8(sizeof(header)) - sizeof(header), file) == Align8(sizeof(header)) - sizeof(header);
+			for (auto& x : section) {
+				if (!ok) {
+					break;
+				}
+				if (x.second > 0) {
+					ok = std::fwrite(x.first, 1, x.second, file) == x.second;
+				}
+				const uint64_t pad = Align8(x.second) - x.second;
+				ok = ok && std::fwrite(zero, 1, pad, file) == pad;
+			}
+			ok = (std::fclose(file) == 0) && ok;
+
+			if (ok) {
+				std::error_code error;
+				std::filesystem::rename(tempName, cacheName, error);
+				ok = !error;
+			}
+			if (!ok) {
+				std::remove(tempName.c_str());
+			}
+			return ok;
+		}
+	};
+
+	class ParseOption {
+	public:
+		// arrays of numbers( same type ) -> UserType::is_packed(), no UserType for elements, same for any thr_num.
+		bool pack_numeric_array = false;
+		// >= 0 : containers deeper than lazy_depth are UserType::is_lazy(), expanded on first access. ( top-level value is 0 )
+		//  needs LazyTape of Parse.
+		int lazy_depth = -1;
+		// not nullptr : only nodes matching projection are built, see Projection. ( not with lazy_depth )
+		const Projection* projection = nullptr;
+		// input text and span of containers are kept in SourceText, see UserType::is_clean, SourceLayout.
+		//  needs SourceText of Parse. ( not with lazy_depth, projection )
+		bool keep_source = false;
+		// nesting limit of simdjson parser, save, clone, remove_all and TreeIterator have no limit.
+		size_t max_depth = simdjson::DEFAULT_MAX_DEPTH;
+		// tape is cached in TapeCache::SidecarName(fileName), and is reused while file is not changed.
+		//  ( not with lazy_depth, keep_source, they need the parser )
+		bool tape_cache = false;
+	};
+
+	// Parse <- not thread-safe?
+	// pool_size - if not nullptr, number of slots of returned pool. ( for PoolManager )
+	// lazy_tape - if option.lazy_depth >= 0, owns tape of lazy subtrees. ( for PoolManager )
+	// source - if option.keep_source, input text, keep it while saving with SourceLayout.
+	inline 	claujson::UserType* Parse(const std::string& fileName, int thr_num, UserType* ut, std::vector<Block>& blocks, int64_t* pool_size,
+		const ParseOption& option, std::unique_ptr<LazyTape>& lazy_tape, std::unique_ptr<SourceText>& source)
+	{
+		if (thr_num <= 0) {
+			thr_num = std::thread::hardware_concurrency();
+		}
+		if (thr_num <= 0) {
+			thr_num = 1;
+		}
+
+		claujson::UserType* pool = nullptr;
+
+		const bool lazy = option.lazy_depth >= 0;
+		if (option.projection) {
+			if (!option.projection->valid()) {
+				std::cout << "not valid projection\n";
+				return nullptr;
+			}
+			if (lazy) {
+				std::cout << "projection with lazy_depth is not supported\n";
+				return nullptr;
+			}
+		}
+		if (option.keep_source && (lazy || option.projection)) {
+			std::cout << "keep_source with lazy_depth or projection is not supported\n";
+			return nullptr;
+		}
+		if (option.tape_cache && (lazy || option.keep_source)) {
+			std::cout << "tape_cache with lazy_depth or keep_source is not supported\n";
+			return nullptr;
+		}
+		// "" in projection -> whole document.
+		const bool projected = option.projection && !option.projection->get_state(0).full;
+
+		if (option.keep_source) {
+			source.reset(new SourceText());
+		}
+
+		if (lazy) {
+			lazy_tape.reset(new LazyTape());
+			lazy_tape->thr_num = thr_num;
+			lazy_tape->pack_numeric_array = option.pack_numeric_array;
+		}
+
+		int _ = clock();
+
+		{
+			static simdjson::dom::parser _test; // chk... recycle? and no parallel?
+			simdjson::dom::parser& test = lazy ? *lazy_tape->parser : _test; // lazy -> tape is kept.
+
+			if (test.max_depth() != option.max_depth) {
+				auto error = test.allocate(test.capacity() > 0 ? test.capacity() : simdjson::SIMDJSON_PADDING, option.max_depth);
+				if (error != simdjson::error_code::SUCCESS) {
+					std::cout << error << "\n";
+					return nullptr;
+				}
+			}
+
+			// unchanged file -> tape of sidecar, no simdjson parse.
+			TapeCache cache;
+			TapeCache::Key cache_key;
+			const bool use_cache = option.tape_cache && TapeCache::GetKey(fileName, thr_num, cache_key);
+			const bool cached = use_cache && cache.load(TapeCache::SidecarName(fileName), cache_key);
+
+			if (!cached) {
+				simdjson::error_code error;
+				if (option.keep_source) {
+					error = simdjson::padded_string::load(fileName).get(source->json);
+					if (!error) {
+						error = test.parse(source->json).error();
+					}
+				}
+				else {
+					error = test.load(fileName).error();
+				}
+
+				if (error != simdjson::error_code::SUCCESS) {
+					std::cout << error << "\n";
+
+					return nullptr;
+				}
+
+				if (use_cache && !TapeCache::save(TapeCache::SidecarName(fileName), cache_key, test.raw_tape().get(), test.raw_string_buf().get())) {
+					std::cout << "tape cache write error\n";
+				}
+			}
+
+			const uint64_t* tape = cached ? cache.tape : test.raw_tape().get();
+			const uint8_t* string_buf = cached ? cache.string_buf : test.raw_string_buf().get();
+
+
+			std::vector<int64_t> start(thr_num + 1, 0);
+			//std::vector<int> key;
+			int64_t length;
+			int a = clock();
+
+			std::cout << a - _ << "ms\n";
+
+
+			{
+				uint32_t string_length;
+				size_t tape_idx = 0;
+				uint64_t tape_val = tape[tape_idx];
+				uint8_t type = uint8_t(tape_val >> 56);
+				uint64_t payload;
+				tape_idx++;
+				size_t how_many = 0;
+				if (type == 'r') {
+					how_many = size_t(tape_val & simdjson::internal::JSON_VALUE_MASK);
+					length = how_many;
+
+					//key = std::vector<int>(how_many, 0);
+				}
+				else {
+					// Error: no starting root node?
+					return nullptr;
+				}
+
+				start[0] = 1;
+				for (int i = 1; i < thr_num; ++i) {
+					start[i] = how_many / thr_num * i;
+				}
+
+				int c = clock();
+
+
+				// no l,u,d  any 
+				 // true      true
 				 // false     true
 				/*
 
-				int count = 1;
-				for (; tape_idx < how_many; tape_idx++) {
-					if (count < thr_num && tape_idx == start[count]) {
-						count++;
+				int count = 1;
+				for (; tape_idx < how_many; tape_idx++) {
+					if (count < thr_num && tape_idx == start[count]) {
+						count++;
+					}
+					else if (count < thr_num && tape_idx == start[count] + 1) {
+						start[count] = tape_idx;
+						count++;
+					}
+
+					tape_val = tape[tape_idx];
+					payload = tape_val & simdjson::internal::JSON_VALUE_MASK;
+					type = uint8_t(tape_val >> 56);
+
+					switch (type) {
+					case 'l':
+					case 'u':
+					case 'd':
+						tape_idx++;
+						break;
+					}
+				}
+				*/
+
+				/*
+				int d = clock();
+				std::cout << d - c << "ms\n";
+				bool now_object = false;
+				bool even = false;
+
+				for (tape_idx = 1; tape_idx < how_many; tape_idx++) {
+
+					//os << tape_idx << " : ";
+					tape_val = tape[tape_idx];
+					payload = tape_val & simdjson::internal::JSON_VALUE_MASK;
+					type = uint8_t(tape_val >> 56);
+
+					even = !even;
+
+					switch (type) {
+					case '"': // we have a string
+						if (now_object && even) {
+							key[tape_idx] = 1;
+						}
+
+						break;
+					case 'l': // we have a long int
+					//	if (tape_idx + 1 >= how_many) {
+					//		return false;
+						//}
+						//  os << "integer " << static_cast<int64_t>(tape[++tape_idx]) << "\n";
+						++tape_idx;
+
+						break;
+					case 'u': // we have a long uint
+						//if (tape_idx + 1 >= how_many) {
+						//	return false;
+						//}
+						//  os << "unsigned integer " << tape[++tape_idx] << "\n";
+						++tape_idx;
+						break;
+					case 'd': // we have a double
+					  //  os << "float ";
+						//if (tape_idx + 1 >= how_many) {
+						//	return false;
+						//}
+
+						// double answer;
+						// std::memcpy(&answer, &tape[++tape_idx], sizeof(answer));
+					   //  os << answer << '\n';
+						++tape_idx;
+						break;
+					case 'n': // we have a null
+					   // os << "null\n";
+						break;
+					case 't': // we have a true
+					   // os << "true\n";
+						break;
+					case 'f': // we have a false
+					  //  os << "false\n";
+						break;
+					case '{': // we have an object
+					 //   os << "{\t// pointing to next tape location " << uint32_t(payload)
+					 //       << " (first node after the scope), "
+					  //      << " saturated count "
+					   //     << ((payload >> 32) & internal::JSON_COUNT_MASK) << "\n";
+						now_object = true; even = false;
+						//_stack.push_back(1);
+						//_stack2.push_back(0);
+						break;
+					case '}': // we end an object
+					  //  os << "}\t// pointing to previous tape location " << uint32_t(payload)
+					  //      << " (start of the scope)\n";
+						//_stack.pop_back();
+						//_stack2.pop_back();
+
+						now_object = key[uint32_t(payload) - 1] == 1; even = false;
+						break;
+					case '[': // we start an array
+					  //  os << "[\t// pointing to next tape location " << uint32_t(payload)
+					  //      << " (first node after the scope), "
+					  //      << " saturated count "
+					   //     << ((payload >> 32) & internal::JSON_COUNT_MASK) << "\n";
+						//_stack.push_back(0);
+						now_object = false; even = false;
+						break;
+					case ']': // we end an array
+					 //   os << "]\t// pointing to previous tape location " << uint32_t(payload)
+					  //      << " (start of the scope)\n";
+						//_stack.pop_back();
+						now_object = key[uint32_t(payload) - 1] == 1; even = false;
+						break;
+					case 'r': // we start and end with the root node
+					  // should we be hitting the root node?
+						break;
+					default:
+
+						return nullptr;
+					}
+				}
+				std::cout << clock() - d << "ms\n";*/
+			}
+
+
+			int b = clock();
+
+			std::cout << b - a << "ms\n";
+
+			start[thr_num] = length - 1;
+
+			if (projected) {
+				int64_t count = 0;
+
+				pool = claujson::LoadData::parse_projected(*ut, string_buf, tape, *option.projection, thr_num, option.pack_numeric_array, count, blocks);
+				if (pool_size) {
+					*pool_size = count;
+				}
+			}
+			else if (lazy) {
+				const int64_t count = claujson::LoadData::parse_lazy(nullptr, *ut, string_buf, tape, length, option.lazy_depth, option.pack_numeric_array, nullptr);
+
+				pool = (claujson::UserType*)calloc(count, sizeof(claujson::UserType));
+				if (pool_size) {
+					*pool_size = count;
+				}
+
+				claujson::LoadData::parse_lazy(pool, *ut, string_buf, tape, length, option.lazy_depth, option.pack_numeric_array, lazy_tape.get());
+			}
+			else {
+				if (option.pack_numeric_array) {
+					int64_t count = 0;
+
+					claujson::LoadData::parse_packed(pool, count, *ut, string_buf, tape, length, start, thr_num, blocks);
+					if (pool_size) {
+						*pool_size = count;
+					}
+				}
+				else {
+					pool = (claujson::UserType*)calloc(length, sizeof(claujson::UserType));
+					if (pool_size) {
+						*pool_size = length;
+					}
+
+					claujson::LoadData::parse(pool, *ut, string_buf, tape, length, start, thr_num, blocks); // 0 : use all thread..
+				}
+
+				if (option.keep_source) {
+					claujson::LoadData::set_source(ut, tape, length, test, *source);
+				}
+			}
+
+			int c = clock();
+			std::cout << c - b << "ms\n";
+		}
+		int c = clock();
+		std::cout << c - _ << "ms\n";
+
+		// claujson::LoadData::_save(std::cout, &ut);
+
+		return pool;
+	}
+
+	inline 	claujson::UserType* Parse(const std::string& fileName, int thr_num, UserType* ut, std::vector<Block>& blocks, int64_t* pool_size = nullptr,
+		const ParseOption& option = ParseOption())
+	{
+		if (option.lazy_depth >= 0) {
+			std::cout << "lazy_depth needs LazyTape\n";
+			return nullptr;
+		}
+
+		if (option.keep_source) {
+			std::cout << "keep_source needs SourceText\n";
+			return nullptr;
+		}
+
+		std::unique_ptr<LazyTape> lazy_tape;
+		std::unique_ptr<SourceText> source;
+		return Parse(fileName, thr_num, ut, blocks, pool_size, option, lazy_tape, source);
+	}
+
+	inline 	claujson::UserType* Parse(const std::string& fileName, int thr_num, UserType* ut, std::vector<Block>& blocks, int64_t* pool_size,
+		const ParseOption& option, std::unique_ptr<LazyTape>& lazy_tape)
+	{
+		if (option.keep_source) {
+			std::cout << "keep_source needs SourceText\n";
+			return nullptr;
+		}
+
+		std::unique_ptr<SourceText> source;
+		return Parse(fileName, thr_num, ut, blocks, pool_size, option, lazy_tape, source);
+	}
+
+	inline 	claujson::UserType* Parse(const std::string& fileName, int thr_num, UserType* ut, std::vector<Block>& blocks, int64_t* pool_size,
+		const ParseOption& option, std::unique_ptr<SourceText>& source)
+	{
+		if (option.lazy_depth >= 0) {
+			std::cout << "lazy_depth needs LazyTape\n";
+			return nullptr;
+		}
+
+		std::unique_ptr<LazyTape> lazy_tape;
+		return Parse(fileName, thr_num, ut, blocks, pool_size, option, lazy_tape, source);
+	}
+
+	// CBOR ( RFC 8949 ) -> UserType tree, see LoadData::parse_cbor, save_cbor.
+	//  returns pool, all slots are used, so no blocks. ( PoolManager(pool, pool_size, {}) )
+	inline claujson::UserType* ParseCbor(std::string_view cbor, int thr_num, UserType* ut, int64_t* pool_size = nullptr) {
+		if (thr_num <= 0) {
+			thr_num = std::thread::hardware_concurrency();
+		}
+		if (thr_num <= 0) {
+			thr_num = 1;
+		}
+
+		int64_t count = 0;
+		claujson::UserType* pool = claujson::LoadData::parse_cbor(*ut, reinterpret_cast<const uint8_t*>(cbor.data()), cbor.size(), thr_num, count);
+		if (pool_size) {
+			*pool_size = count;
+		}
+		return pool;
+	}
+
+	inline claujson::UserType* ParseCborFile(const std::string& fileName, int thr_num, UserType* ut, int64_t* pool_size = nullptr) {
+		MappedFile file;
+		if (!file.open(fileName)) {
+			std::cout << "file open error " << fileName << "\n";
+			return nullptr;
+		}
+		return ParseCbor(std::string_view(reinterpret_cast<const char*>(file.data()), file.size()), thr_num, ut, pool_size);
+	}
+
+	inline int Parse_One(const std::string& str, Data& data) {
+		{
+			static simdjson::dom::parser test;
+
+			auto x = test.parse(str);
+
+			if (x.error() != simdjson::error_code::SUCCESS) {
+				std::cout << x.error() << "\n";
+
+				return -1;
+			}
+
+			const uint64_t* tape = test.raw_tape().get();
+			const uint8_t* string_buf = test.raw_string_buf().get();
+
+			Convert(data, &tape[1], false, string_buf);
+		}
+		return 0;
+	}
+
+	// one-shot field extraction by simdjson::ondemand, no tape and no tree for the document.
+	//  fields are JSON Pointers, document is rewound for each get. not thread-safe.
+	//  find, get_data_list, get_data_size are same as UserType`s for scalars, containers -> get_tree.
+	class OnDemand {
+	private:
+		simdjson::ondemand::parser parser;
+		simdjson::padded_string json;
+		simdjson::ondemand::document doc;
+		bool loaded = false;
+	public:
+		bool load(const std::string& fileName) {
+			loaded = false;
+
+			auto error = simdjson::padded_string::load(fileName).get(json);
+			if (error != simdjson::error_code::SUCCESS) {
+				std::cout << error << "\n";
+				return false;
+			}
+
+			return iterate();
+		}
+
+		// str is copied.
+		bool load_str(std::string_view str) {
+			loaded = false;
+			json = simdjson::padded_string(str);
+
+			return iterate();
+		}
+
+		// scalar at pointer -> data, false if not found or container. ( see get_tree )
+		bool get_data(std::string_view pointer, Data& data) {
+			if (!loaded) {
+				return false;
+			}
+
+			simdjson::ondemand::value value;
+			if (doc.at_pointer(pointer).get(value)) {
+				return false;
+			}
+			return to_data(value, data);
+		}
+
+		// like UserType::find, scalar of member key of object at pointer -> data.
+		//  key is not escaped, false if not found or container.
+		bool find(std::string_view pointer, std::string_view key, Data& data) {
+			if (!loaded) {
+				return false;
+			}
+
+			simdjson::ondemand::value value;
+			simdjson::ondemand::object obj;
+			if (doc.at_pointer(pointer).get(value) || value.get_object().get(obj) || obj.find_field_unordered(key).get(value)) {
+				return false;
+			}
+			return to_data(value, data);
+		}
+
+		// like UserType::get_data_size, number of elements or members of container at pointer, -1 if not found or scalar.
+		int64_t get_data_size(std::string_view pointer) {
+			if (!loaded) {
+				return -1;
+			}
+
+			simdjson::ondemand::value value;
+			simdjson::ondemand::json_type type;
+			size_t count = 0;
+			if (doc.at_pointer(pointer).get(value) || value.type().get(type)) {
+				return -1;
+			}
+
+			switch (type) {
+			case simdjson::ondemand::json_type::array:
+				if (value.count_elements().get(count)) {
+					return -1;
+				}
+				break;
+			case simdjson::ondemand::json_type::object:
+				if (value.count_fields().get(count)) {
+					return -1;
+				}
+				break;
+			default:
+				return -1;
+			}
+			return int64_t(count);
+		}
+
+		// like UserType::get_data_list, scalar of idx-th element or member of container at pointer -> data,
+		//  key of member -> key if not nullptr. false if not found or container, O(idx).
+		bool get_data_list(std::string_view pointer, size_t idx, Data& data, Data* key = nullptr) {
+			if (!loaded) {
+				return false;
+			}
+
+			simdjson::ondemand::value value;
+			simdjson::ondemand::json_type type;
+			if (doc.at_pointer(pointer).get(value) || value.type().get(type)) {
+				return false;
+			}
+
+			size_t i = 0;
+
+			switch (type) {
+			case simdjson::ondemand::json_type::array:
+			{
+				simdjson::ondemand::array arr;
+				if (value.get_array().get(arr)) {
+					return false;
+				}
+				for (auto x : arr) {
+					if (i++ < idx) {
+						continue;
+					}
+					if (x.get(value)) {
+						return false;
+					}
+					if (key) {
+						key->clear();
+					}
+					return to_data(value, data);
+				}
+			}
+			break;
+			case simdjson::ondemand::json_type::object:
+			{
+				simdjson::ondemand::object obj;
+				if (value.get_object().get(obj)) {
+					return false;
+				}
+				for (auto x : obj) {
+					if (i++ < idx) {
+						continue;
+					}
+					std::string_view str;
+					if (x.unescaped_key().get(str) || x.value().get(value)) {
+						return false;
+					}
+					if (key) {
+						key->clear();
+						key->is_key = true;
+						key->type = simdjson::internal::tape_type::STRING;
+						key->set_str_val(str.data(), str.size());
+					}
+					return to_data(value, data);
+				}
+			}
+			break;
+			default:
+				break;
+			}
+			return false;
+		}
+
+		// text of value at pointer, empty if not found.
+		std::string_view get_raw(std::string_view pointer) {
+			std::string_view str;
+
+			if (!loaded) {
+				return str;
+			}
+
+			simdjson::ondemand::value value;
+			simdjson::ondemand::json_type type;
+
+			if (pointer.empty()) {
+				if (doc.at_pointer(pointer).error() || doc.raw_json().get(str)) { // at_pointer -> rewind
+					return std::string_view();
+				}
+				return str;
+			}
+			if (doc.at_pointer(pointer).get(value) || value.type().get(type)) {
+				return str;
+			}
+
+			switch (type) {
+			case simdjson::ondemand::json_type::object:
+			{
+				simdjson::ondemand::object obj;
+				if (value.get_object().get(obj) || obj.raw_json().get(str)) {
+					return std::string_view();
+				}
+			}
+			break;
+			case simdjson::ondemand::json_type::array:
+			{
+				simdjson::ondemand::array arr;
+				if (value.get_array().get(arr) || arr.raw_json().get(str)) {
+					return std::string_view();
+				}
+			}
+			break;
+			default:
+				str = value.raw_json_token();
+				break;
+			}
+			return str;
+		}
+
+		// whole subtree at pointer -> full materialization, only the text of the subtree is parsed.
+		//  ut, blocks, pool_size, return : same as Parse.
+		UserType* get_tree(std::string_view pointer, int thr_num, UserType* ut, std::vector<Block>& blocks, int64_t* pool_size = nullptr,
+			bool pack_numeric_array = false) {
+			const std::string_view str = get_raw(pointer);
+			if (str.empty()) {
+				std::cout << "not found " << pointer << "\n";
+				return nullptr;
+			}
+
+			if (thr_num <= 0) {
+				thr_num = std::thread::hardware_concurrency();
+			}
+			if (thr_num <= 0) {
+				thr_num = 1;
+			}
+
+			simdjson::dom::parser test;
+
+			auto x = test.parse(str.data(), str.size(), true);
+			if (x.error() != simdjson::error_code::SUCCESS) {
+				std::cout << x.error() << "\n";
+				return nullptr;
+			}
+
+			const uint64_t* tape = test.raw_tape().get();
+			const uint8_t* string_buf = test.raw_string_buf().get();
+
+			const int64_t length = tape[0] & simdjson::internal::JSON_VALUE_MASK;
+			std::vector<int64_t> start(thr_num + 1, 0);
+
+			start[0] = 1;
+			for (int i = 1; i < thr_num; ++i) {
+				start[i] = length / thr_num * i;
+			}
+			start[thr_num] = length - 1;
+
+			UserType* pool = nullptr;
+
+			if (pack_numeric_array) {
+				int64_t count = 0;
+
+				claujson::LoadData::parse_packed(pool, count, *ut, string_buf, tape, length, start, thr_num, blocks);
+				if (pool_size) {
+					*pool_size = count;
+				}
+				return pool;
+			}
+
+			pool = (claujson::UserType*)calloc(length, sizeof(claujson::UserType));
+			if (pool_size) {
+				*pool_size = length;
+			}
+
+			claujson::LoadData::parse(pool, *ut, string_buf, tape, length, start, thr_num, blocks);
+
+			return pool;
+		}
+	private:
+		// scalar value -> data, false if container.
+		bool to_data(simdjson::ondemand::value& value, Data& data) {
+			simdjson::ondemand::json_type type;
+			if (value.type().get(type)) {
+				return false;
+			}
+
+			data.clear(); // no str_val of before, like Convert.
+
+			switch (type) {
+			case simdjson::ondemand::json_type::string:
+			{
+				std::string_view str;
+				if (value.get_string().get(str)) {
+					return false;
+				}
+				data.type = simdjson::internal::tape_type::STRING;
+				data.set_str_val(str.data(), str.size());
+			}
+			break;
+			case simdjson::ondemand::json_type::number:
+			{
+				simdjson::ondemand::number_type number_type;
+				if (value.get_number_type().get(number_type)) {
+					return false;
+				}
+				switch (number_type) {
+				case simdjson::ondemand::number_type::signed_integer:
+				{
+					int64_t x; // int_val is long long, not int64_t. ( LP64 )
+					if (value.get_int64().get(x)) {
+						return false;
+					}
+					data.type = simdjson::internal::tape_type::INT64;
+					data.int_val = x;
+					return true;
+				}
+				case simdjson::ondemand::number_type::unsigned_integer:
+				{
+					uint64_t x;
+					if (value.get_uint64().get(x)) {
+						return false;
+					}
+					data.type = simdjson::internal::tape_type::UINT64;
+					data.uint_val = x;
+					return true;
+				}
+				default:
+					data.type = simdjson::internal::tape_type::DOUBLE;
+					return !value.get_double().get(data.float_val);
+				}
+			}
+			break;
+			case simdjson::ondemand::json_type::boolean:
+			{
+				bool x;
+				if (value.get_bool().get(x)) {
+					return false;
+				}
+				data.type = x ? simdjson::internal::tape_type::TRUE_VALUE : simdjson::internal::tape_type::FALSE_VALUE;
+			}
+			break;
+			case simdjson::ondemand::json_type::null:
+				data.type = simdjson::internal::tape_type::NULL_VALUE;
+				break;
+			default:
+				return false;
+			}
+			return true;
+		}
+
+		bool iterate() {
+			auto error = parser.iterate(json).get(doc);
+			if (error != simdjson::error_code::SUCCESS) {
+				std::cout << error << "\n";
+				return false;
+			}
+			loaded = true;
+			return true;
+		}
+	};
+
+	// match of Query, element of packed array has packed_idx >= 0.
+	class QueryResult {
+	public:
+		UserType* ut = nullptr;
+		int64_t packed_idx = -1;
+
+		bool is_packed_element() const { return packed_idx >= 0; }
+
+		// value of item type or packed element.
+		Data get_data() const {
+			if (packed_idx >= 0) {
+				return ut->get_packed_data(packed_idx);
+			}
+			return ut->get_value().data;
+		}
+	};
+
+	// JSONPath subset, compiled once, see Query::eval
+	//  $  .name  ['name','name2']  .*  [*]  ..name  ..*  [0]  [-1]  [0,2]  [start:end:step]
+	//  [?(@.a.b)]  [?(@.a[0] op literal)]  op : == != < <= > >=, literal : number, 'string', "string", true, false, null
+	class Query {
+	public:
+		enum class StepType { NAME, WILDCARD, INDEX, SLICE, FILTER };
+		enum class Op { EXISTS, EQ, NE, LT, LE, GT, GE };
+
+		// @.name or @[idx]
+		class PathElem {
+		public:
+			std::string name;
+			int64_t idx = 0;
+			bool is_index = false;
+		};
+
+		class Step {
+		public:
+			StepType type = StepType::WILDCARD;
+			bool descendant = false; // ..
+			std::vector<std::string> names;
+			std::vector<int64_t> idx;
+			int64_t start = 0, end = 0, step = 1;
+			bool has_start = false, has_end = false;
+			std::vector<PathElem> path; // filter
+			Op op = Op::EXISTS;
+			Data literal;
+		};
+	private:
+		std::vector<Step> steps;
+		bool ok = false;
+
+		inline const static size_t min_len = 1 << 14; // children per thread.
+	public:
+		Query() { }
+
+		explicit Query(const std::string& expr) {
+			compile(expr);
+		}
+
+		bool valid() const { return ok; }
+
+		const std::vector<Step>& get_steps() const { return steps; }
+
+		bool compile(const std::string& expr) {
+			steps.clear();
+			ok = false;
+
+			size_t i = 0;
+			skip_space(expr, i);
+			if (i >= expr.size() || expr[i] != '$') {
+				std::cout << "query must start with $\n";
+				return false;
+			}
+			++i;
+
+			while (true) {
+				skip_space(expr, i);
+				if (i >= expr.size()) {
+					break;
+				}
+
+				Step step;
+
+				if (expr.compare(i, 2, "..") == 0) {
+					step.descendant = true;
+					i += 2;
+					if (i < expr.size() && expr[i] == '[') {
+						if (!parse_bracket(expr, i, step)) {
+							return false;
+						}
+					}
+					else if (!parse_dot(expr, i, step)) {
+						return false;
+					}
+				}
+				else if (expr[i] == '.') {
+					++i;
+					if (!parse_dot(expr, i, step)) {
+						return false;
+					}
+				}
+				else if (expr[i] == '[') {
+					if (!parse_bracket(expr, i, step)) {
+						return false;
+					}
+				}
+				else {
+					std::cout << "not valid query at " << i << "\n";
+					return false;
+				}
+
+				steps.push_back(std::move(step));
+			}
+
+			ok = true;
+			return ok;
+		}
+
+		// matches in document order, root is UserType of Parse or any container.
+		//  large arrays ( and objects ) are split into thr_num tasks, each fills its own vector.
+		std::vector<QueryResult> eval(UserType* root, int thr_num = 0) const {
+			std::vector<QueryResult> out;
+
+			if (!ok || !root) {
+				return out;
+			}
+			if (thr_num <= 0) {
+				thr_num = std::thread::hardware_concurrency();
+			}
+			if (thr_num <= 0) {
+				thr_num = 1;
+			}
+
+			QueryResult start;
+			start.ut = root;
+			if (root->is_root()) {
+				if (root->get_data_size() == 0) {
+					return out;
+				}
+				start.ut = root->get_data_list(0);
+			}
+
+			eval(0, start, out, thr_num);
+			return out;
+		}
+
+	private:
+		static void skip_space(const std::string& expr, size_t& i) {
+			while (i < expr.size() && isspace((unsigned char)expr[i])) {
+				++i;
+			}
+		}
+
+		static bool parse_name(const std::string& expr, size_t& i, std::string& name) {
+			const size_t start = i;
+			while (i < expr.size() && expr[i] != '.' && expr[i] != '[' && !isspace((unsigned char)expr[i])
+				&& expr[i] != ')' && expr[i] != '=' && expr[i] != '!' && expr[i] != '<' && expr[i] != '>') {
+				++i;
+			}
+			name = expr.substr(start, i - start);
+			return !name.empty();
+		}
+
+		static bool parse_string(const std::string& expr, size_t& i, std::string& str) {
+			const char quote = expr[i];
+			++i;
+			str.clear();
+			while (i < expr.size() && expr[i] != quote) {
+				if (expr[i] == '\\' && i + 1 < expr.size()) {
+					++i;
+				}
+				str.push_back(expr[i]);
+				++i;
+			}
+			if (i >= expr.size()) {
+				return false;
+			}
+			++i;
+			return true;
+		}
+
+		static bool parse_int(const std::string& expr, size_t& i, int64_t& x) {
+			skip_space(expr, i);
+			const char* first = expr.c_str() + i;
+			char* last = nullptr;
+			x = strtoll(first, &last, 10);
+			if (last == first) {
+				return false;
+			}
+			i += last - first;
+			skip_space(expr, i);
+			return true;
+		}
+
+		static bool parse_literal(const std::string& expr, size_t& i, Data& data) {
+			skip_space(expr, i);
+			if (i >= expr.size()) {
+				return false;
+			}
+			if (expr[i] == '\'' || expr[i] == '"') {
+				std::string str;
+				if (!parse_string(expr, i, str)) {
+					return false;
+				}
+				data.type = simdjson::internal::tape_type::STRING;
+				data.set_str_val(std::move(str));
+				return true;
+			}
+			if (expr.compare(i, 4, "true") == 0) {
+				data.type = simdjson::internal::tape_type::TRUE_VALUE; i += 4;
+				return true;
+			}
+			if (expr.compare(i, 5, "false") == 0) {
+				data.type = simdjson::internal::tape_type::FALSE_VALUE; i += 5;
+				return true;
+			}
+			if (expr.compare(i, 4, "null") == 0) {
+				data.type = simdjson::internal::tape_type::NULL_VALUE; i += 4;
+				return true;
+			}
+
+			const char* first = expr.c_str() + i;
+			char* last = nullptr;
+			bool is_double = false;
+			for (const char* x = first; *x && *x != ')' && !isspace((unsigned char)*x); ++x) {
+				if (*x == '.' || *x == 'e' || *x == 'E') {
+					is_double = true;
+				}
+			}
+			if (is_double) {
+				data.type = simdjson::internal::tape_type::DOUBLE;
+				data.float_val = strtod(first, &last);
+			}
+			else {
+				data.type = simdjson::internal::tape_type::INT64;
+				data.int_val = strtoll(first, &last, 10);
+			}
+			if (last == first) {
+				return false;
+			}
+			i += last - first;
+			return true;
+		}
+
+		// after '.' or '..'
+		static bool parse_dot(const std::string& expr, size_t& i, Step& step) {
+			if (i < expr.size() && expr[i] == '*') {
+				step.type = StepType::WILDCARD;
+				++i;
+				return true;
+			}
+			std::string name;
+			if (!parse_name(expr, i, name)) {
+				std::cout << "not valid name in query at " << i << "\n";
+				return false;
+			}
+			step.type = StepType::NAME;
+			step.names.push_back(std::move(name));
+			return true;
+		}
+
+		// @.a['b'][0] op literal
+		static bool parse_filter(const std::string& expr, size_t& i, Step& step) {
+			step.type = StepType::FILTER;
+
+			skip_space(expr, i);
+			if (i >= expr.size() || expr[i] != '(') {
+				return false;
+			}
+			++i;
+			skip_space(expr, i);
+			if (i >= expr.size() || expr[i] != '@') {
+				return false;
+			}
+			++i;
+
+			while (i < expr.size()) {
+				PathElem elem;
+				if (expr[i] == '.') {
+					++i;
+					if (!parse_name(expr, i, elem.name)) {
+						return false;
+					}
+				}
+				else if (expr[i] == '[') {
+					++i;
+					skip_space(expr, i);
+					if (i < expr.size() && (expr[i] == '\'' || expr[i] == '"')) {
+						if (!parse_string(expr, i, elem.name)) {
+							return false;
+						}
+						skip_space(expr, i);
+					}
+					else {
+						elem.is_index = true;
+						if (!parse_int(expr, i, elem.idx)) {
+							return false;
+						}
+					}
+					if (i >= expr.size() || expr[i] != ']') {
+						return false;
+					}
+					++i;
+				}
+				else {
+					break;
+				}
+				step.path.push_back(std::move(elem));
+			}
+
+			skip_space(expr, i);
+			if (i < expr.size() && expr[i] != ')') {
+				static const std::pair<const char*, Op> ops[] = { { "==", Op::EQ }, { "!=", Op::NE }, { "<=", Op::LE }, { ">=", Op::GE }, { "<", Op::LT }, { ">", Op::GT } };
+
+				bool found = false;
+				for (const auto& x : ops) {
+					const size_t len = strlen(x.first);
+					if (expr.compare(i, len, x.first) == 0) {
+						step.op = x.second;
+						i += len;
+						found = true;
+						break;
+					}
+				}
+				if (!found || !parse_literal(expr, i, step.literal)) {
+					return false;
+				}
+				skip_space(expr, i);
+			}
+			if (i >= expr.size() || expr[i] != ')') {
+				return false;
+			}
+			++i;
+			return true;
+		}
+
+		static bool parse_bracket(const std::string& expr, size_t& i, Step& step) {
+			++i; // '['
+			skip_space(expr, i);
+			if (i >= expr.size()) {
+				return false;
+			}
+
+			bool valid = true;
+
+			if (expr[i] == '*') {
+				step.type = StepType::WILDCARD;
+				++i;
+			}
+			else if (expr[i] == '?') {
+				++i;
+				valid = parse_filter(expr, i, step);
+			}
+			else if (expr[i] == '\'' || expr[i] == '"') {
+				step.type = StepType::NAME;
+				while (valid) {
+					std::string name;
+					valid = parse_string(expr, i, name);
+					step.names.push_back(std::move(name));
+					skip_space(expr, i);
+					if (i < expr.size() && expr[i] == ',') {
+						++i;
+						skip_space(expr, i);
+						continue;
+					}
+					break;
+				}
+			}
+			else {
+				int64_t x = 0;
+				const bool has_first = parse_int(expr, i, x);
+
+				if (i < expr.size() && expr[i] == ':') {
+					step.type = StepType::SLICE;
+					step.has_start = has_first;
+					step.start = x;
+					++i;
+					step.has_end = parse_int(expr, i, step.end);
+					if (i < expr.size() && expr[i] == ':') {
+						++i;
+						if (!parse_int(expr, i, step.step)) {
+							step.step = 1;
+						}
+					}
+					valid = step.step != 0;
+				}
+				else {
+					step.type = StepType::INDEX;
+					valid = has_first;
+					step.idx.push_back(x);
+					while (valid && i < expr.size() && expr[i] == ',') {
+						++i;
+						valid = parse_int(expr, i, x);
+						step.idx.push_back(x);
+					}
+				}
+			}
+
+			skip_space(expr, i);
+			if (!valid || i >= expr.size() || expr[i] != ']') {
+				std::cout << "not valid [] in query at " << i << "\n";
+				return false;
+			}
+			++i;
+			return true;
+		}
+
+	private:
+		static size_t child_count(const QueryResult& x) {
+			if (x.packed_idx >= 0 || !x.ut->is_user_type()) {
+				return 0;
+			}
+			return x.ut->is_packed() ? x.ut->get_packed_size() : x.ut->get_data_size();
+		}
+
+		static QueryResult child(const QueryResult& x, size_t i) {
+			QueryResult result;
+			result.ut = x.ut;
+			if (x.ut->is_packed()) {
+				result.packed_idx = i;
+			}
+			else {
+				result.ut = x.ut->get_data_list(i);
+			}
+			return result;
+		}
+
+		static bool compare(const Data& x, const Data& y, Op op) {
+			using simdjson::internal::tape_type;
+
+			auto is_number = [](tape_type type) {
+				return type == tape_type::INT64 || type == tape_type::UINT64 || type == tape_type::DOUBLE;
+			};
+
+			int cmp = 0;
+
+			if (is_number(x.type) && is_number(y.type)) {
+				if (x.type == tape_type::INT64 && y.type == tape_type::INT64) {
+					cmp = x.int_val < y.int_val ? -1 : x.int_val > y.int_val;
+				}
+				else if (x.type == tape_type::UINT64 && y.type == tape_type::UINT64) {
+					cmp = x.uint_val < y.uint_val ? -1 : x.uint_val > y.uint_val;
+				}
+				else {
+					auto as_double = [](const Data& d) {
+						return d.type == tape_type::INT64 ? double(d.int_val) : d.type == tape_type::UINT64 ? double(d.uint_val) : d.float_val;
+					};
+					const double a = as_double(x), b = as_double(y);
+					cmp = a < b ? -1 : a > b;
+				}
+			}
+			else if (x.type == tape_type::STRING && y.type == tape_type::STRING) {
+				cmp = x.get_str_val()->compare(*y.get_str_val());
+			}
+			else if (x.type == y.type && (x.type == tape_type::TRUE_VALUE || x.type == tape_type::FALSE_VALUE || x.type == tape_type::NULL_VALUE)) {
+				return op == Op::EQ || op == Op::LE || op == Op::GE;
+			}
+			else {
+				return op == Op::NE;
+			}
+
+			switch (op) {
+			case Op::EQ: return cmp == 0;
+			case Op::NE: return cmp != 0;
+			case Op::LT: return cmp < 0;
+			case Op::LE: return cmp <= 0;
+			case Op::GT: return cmp > 0;
+			case Op::GE: return cmp >= 0;
+			default: return true;
+			}
+		}
+
+		static bool test(const Step& step, const QueryResult& x) {
+			QueryResult now = x;
+
+			for (const PathElem& elem : step.path) {
+				if (now.packed_idx >= 0 || !now.ut->is_user_type()) {
+					return false;
+				}
+				if (elem.is_index) {
+					if (!now.ut->is_array()) {
+						return false;
+					}
+					const int64_t n = child_count(now);
+					const int64_t idx = elem.idx < 0 ? elem.idx + n : elem.idx;
+					if (idx < 0 || idx >= n) {
+						return false;
+					}
+					now = child(now, idx);
+				}
+				else {
+					if (!now.ut->is_object()) {
+						return false;
+					}
+					UserType* ut = now.ut->find(elem.name);
+					if (!ut) {
+						return false;
+					}
+					now.ut = ut;
+				}
+			}
+
+			if (step.op == Op::EXISTS) {
+				return true;
+			}
+			if (now.packed_idx < 0 && now.ut->is_user_type()) {
+				return false;
+			}
+			return compare(now.get_data(), step.literal, step.op);
+		}
+
+		// child i of x by step ( not NAME, INDEX ).
+		static bool select(const Step& step, const QueryResult& x, size_t i) {
+			switch (step.type) {
+			case StepType::WILDCARD:
+				return true;
+			case StepType::FILTER:
+				return test(step, child(x, i));
+			default:
+				return false;
+			}
+		}
+
+		// steps[k] to children of x in [first, last), then steps[k + 1 ...].
+		void eval_range(size_t k, const QueryResult& x, size_t first, size_t last, std::vector<QueryResult>& out, int thr_num) const {
+			const Step& step = steps[k];
+
+			if (thr_num > 1 && last - first >= 2 * min_len) {
+				size_t n = std::min<size_t>(thr_num, (last - first) / min_len);
+				std::vector<std::vector<QueryResult>> part(n);
+				std::vector<std::future<void>> thr(n);
+
+				for (size_t t = 1; t < n; ++t) {
+					const size_t _first = first + (last - first) / n * t;
+					const size_t _last = t + 1 == n ? last : first + (last - first) / n * (t + 1);
+					thr[t] = std::async(std::launch::async, [this, k, &x, _first, _last, &part, t]() {
+						eval_range(k, x, _first, _last, part[t], 1);
+					});
+				}
+				eval_range(k, x, first, first + (last - first) / n, out, 1);
+				for (size_t t = 1; t < n; ++t) {
+					thr[t].get();
+					out.insert(out.end(), part[t].begin(), part[t].end());
+				}
+				return;
+			}
+
+			for (size_t i = first; i < last; ++i) {
+				if (select(step, x, i)) {
+					eval(k + 1, child(x, i), out, thr_num);
+				}
+			}
+		}
+
+		// steps[k] without '..' to x.
+		void apply(size_t k, const QueryResult& x, std::vector<QueryResult>& out, int thr_num) const {
+			const Step& step = steps[k];
+			const int64_t n = child_count(x);
+
+			if (n == 0) {
+				return;
+			}
+
+			switch (step.type) {
+			case StepType::NAME:
+				if (x.ut->is_object()) {
+					for (const std::string& name : step.names) {
+						for (int64_t i = 0; i < n; ++i) {
+							const UserType* ut = x.ut->get_data_list(i);
+							if (ut->get_value().key.is_key && *ut->get_value().key.get_str_val() == name) {
+								eval(k + 1, child(x, i), out, thr_num);
+							}
+						}
+					}
+				}
+				break;
+			case StepType::INDEX:
+				if (x.ut->is_array()) {
+					for (int64_t idx : step.idx) {
+						if (idx < 0) {
+							idx += n;
+						}
+						if (0 <= idx && idx < n) {
+							eval(k + 1, child(x, idx), out, thr_num);
+						}
+					}
+				}
+				break;
+			case StepType::SLICE:
+				if (x.ut->is_array()) {
+					auto norm = [n](int64_t i) { return i < 0 ? std::max<int64_t>(i + n, -1) : std::min<int64_t>(i, n); };
+
+					if (step.step > 0) {
+						const int64_t first = step.has_start ? std::max<int64_t>(norm(step.start), 0) : 0;
+						const int64_t last = step.has_end ? norm(step.end) : n;
+						for (int64_t i = first; i < last; i += step.step) {
+							eval(k + 1, child(x, i), out, thr_num);
+						}
+					}
+					else {
+						const int64_t first = step.has_start ? std::min<int64_t>(norm(step.start), n - 1) : n - 1;
+						const int64_t last = step.has_end ? norm(step.end) : -1;
+						for (int64_t i = first; i > last; i += step.step) {
+							eval(k + 1, child(x, i), out, thr_num);
+						}
+					}
+				}
+				break;
+			default:
+				eval_range(k, x, 0, n, out, thr_num);
+				break;
+			}
+		}
+
+		// ..steps[k] - x and all of its descendants.
+		void descend(size_t k, const QueryResult& x, std::vector<QueryResult>& out, int thr_num) const {
+			apply(k, x, out, thr_num);
+			descend_children(k, x, out, thr_num);
+		}
+
+		// ..steps[k] - descendants of x, in pre-order. many children -> split by threads.
+		void descend_children(size_t k, const QueryResult& x, std::vector<QueryResult>& out, int thr_num) const {
+			const size_t n = child_count(x);
+			if (n == 0 || x.ut->is_packed()) {
+				return;
+			}
+
+			if (thr_num > 1 && n >= 2 * min_len) {
+				size_t m = std::min<size_t>(thr_num, n / min_len);
+				std::vector<std::vector<QueryResult>> part(m);
+				std::vector<std::future<void>> thr(m);
+
+				for (size_t t = 1; t < m; ++t) {
+					const size_t first = n / m * t;
+					const size_t last = t + 1 == m ? n : n / m * (t + 1);
+					thr[t] = std::async(std::launch::async, [this, k, &x, first, last, &part, t]() {
+						descend_range(k, x, first, last, part[t], 1);
+					});
+				}
+				descend_range(k, x, 0, n / m, out, 1);
+				for (size_t t = 1; t < m; ++t) {
+					thr[t].get();
+					out.insert(out.end(), part[t].begin(), part[t].end());
+				}
+				return;
+			}
+
+			descend_range(k, x, 0, n, out, thr_num);
+		}
+
+		// ..steps[k] - children [first, last) of x and their descendants, explicit stack, no recursion.
+		void descend_range(size_t k, const QueryResult& x, size_t first, size_t last, std::vector<QueryResult>& out, int thr_num) const {
+			class Frame {
+			public:
+				QueryResult x;
+				size_t i;
+				size_t last;
+			};
+
+			std::vector<Frame> _stack;
+			_stack.push_back(Frame{ x, first, last });
+
+			while (!_stack.empty()) {
+				Frame& top = _stack.back();
+				if (top.i == top.last) {
+					_stack.pop_back();
+					continue;
+				}
+
+				const QueryResult y = child(top.x, top.i);
+				++top.i;
+
+				apply(k, y, out, thr_num);
+
+				const size_t n = child_count(y);
+				if (n == 0 || y.ut->is_packed()) {
+					continue;
+				}
+
+				if (thr_num > 1 && n >= 2 * min_len) {
+					descend_children(k, y, out, thr_num);
+				}
+				else {
+					_stack.push_back(Frame{ y, 0, n }); // top is invalid now.
+				}
+			}
+		}
+
+		void eval(size_t k, const QueryResult& x, std::vector<QueryResult>& out, int thr_num) const {
+			if (k == steps.size()) {
+				out.push_back(x);
+				return;
+			}
+			if (steps[k].descendant) {
+				descend(k, x, out, thr_num);
+			}
+			else {
+				apply(k, x, out, thr_num);
+			}
+		}
+	};
+
+	// read only tree, for read-mostly documents.
+	//  nodes are in pre-order in one array,
+	//  children of container are children[first_child, first_child + child_count).
+	//  nodes refer to each other by 32-bit index, strings by offset, so no pointer in the tree. ( relocatable )
+	class FrozenNode {
+	public:
+		inline const static uint32_t npos = (uint32_t)-1;
+		inline const static uint32_t max_shape = (1 << 24) - 1;
+
+		uint32_t type : 8; // simdjson::internal::tape_type, 'r' - root.
+		uint32_t shape : 24; // object only, 0 - no shape.
+		uint32_t key = npos; // offset of key in strings, slot if parent has shape, npos - no key.
+		uint64_t payload = 0; // number, offset of string in strings, or first_child | child_count << 32.
+
+		FrozenNode() : type(0), shape(0) { }
+
+		uint32_t first_child() const { return uint32_t(payload); }
+		uint32_t child_count() const { return uint32_t(payload >> 32); }
+	};
+
+	// key sequence of objects, shared by objects with same keys.
+	//  children of shaped object have slot ( position in shape ) as FrozenNode::key, not key.
+	class FrozenShape {
+	public:
+		uint32_t first_key = 0; // in FrozenDocument::shape_keys
+		uint32_t key_count = 0;
+		uint32_t first_index = 0; // in FrozenDocument::shape_index, open addressing, key hash -> slot.
+		uint32_t index_mask = 0; // index size - 1, size is power of 2 and >= 2 * key_count.
+
+		// FNV-1a, same in snapshot files.
+		static uint32_t Hash(std::string_view key) {
+			uint32_t h = 2166136261u;
+			for (char c : key) {
+				h = (h ^ uint8_t(c)) * 16777619u;
+			}
+			return h;
+		}
+	};
+
+	class FrozenDocument;
+
+	// handle of FrozenNode, same read api with UserType.
+	class FrozenType {
+	private:
+		const FrozenDocument* doc = nullptr;
+		uint32_t idx = FrozenNode::npos;
+	public:
+		FrozenType() { }
+		FrozenType(const FrozenDocument* doc, uint32_t idx) : doc(doc), idx(idx) { }
+
+		bool valid() const { return doc && idx != FrozenNode::npos; }
+		explicit operator bool() const { return valid(); }
+		uint32_t get_idx() const { return idx; }
+
+		inline const FrozenNode& get_node() const;
+
+		simdjson::internal::tape_type get_type() const { return static_cast<simdjson::internal::tape_type>(get_node().type); }
+
+		bool is_root() const { return get_node().type == 'r'; }
+		bool is_object() const { return get_node().type == '{'; }
+		bool is_array() const { return get_node().type == '['; }
+		bool is_user_type() const { return is_object() || is_array(); }
+		bool is_item_type() const { return !is_user_type() && !is_root(); }
+
+		size_t get_data_size() const {
+			return is_user_type() || is_root() ? get_node().child_count() : 0;
+		}
+
+		inline FrozenType get_data_list(size_t idx) const;
+		inline FrozenType find(std::string_view key) const;
+
+		inline FrozenType get_parent() const;
+
+		uint32_t get_shape() const { return get_node().shape; }
+
+		bool has_key() const { return get_node().key != FrozenNode::npos; }
+		inline std::string_view get_key() const;
+
+		inline std::string_view get_string() const;
+		int64_t get_int64() const { int64_t x; std::memcpy(&x, &get_node().payload, sizeof(x)); return x; }
+		uint64_t get_uint64() const { return get_node().payload; }
+		double get_double() const { double x; std::memcpy(&x, &get_node().payload, sizeof(x)); return x; }
+		bool get_bool() const { return get_node().type == 't'; }
+		bool is_null() const { return get_node().type == 'n'; }
+
+		// copy to Data, same with UserType::get_value.
+		inline ItemType get_value() const;
+	};
+
+	class FrozenDocument {
+	private:
+		std::unique_ptr<simdjson::dom::parser> parser; // has string_buf, from Build.
+		std::vector<uint8_t> string_table; // same format with string_buf, from Freeze.
+		const uint8_t* strings = nullptr; // string_buf or string_table
+
+		std::vector<FrozenNode> nodes;
+		std::vector<uint32_t> children;
+		std::vector<uint32_t> parents; // npos for root, not in FrozenNode to keep it 16 bytes.
+
+		std::vector<FrozenShape> shapes; // shapes[0] - no shape.
+		std::vector<uint32_t> shape_keys; // key offsets in strings.
+		std::vector<uint32_t> shape_index; // slots of FrozenShape, npos - empty.
+
+		// read views, point to vectors above or to the mapped snapshot.
+		MappedFile snapshot;
+		const FrozenNode* node_view = nullptr;
+		const uint32_t* children_view = nullptr;
+		const uint32_t* parents_view = nullptr;
+		const FrozenShape* shapes_view = nullptr;
+		const uint32_t* shape_keys_view = nullptr;
+		const uint32_t* shape_index_view = nullptr;
+		size_t node_view_size = 0;
+		size_t children_view_size = 0;
+		size_t shapes_view_size = 0;
+		size_t shape_keys_view_size = 0;
+		size_t shape_index_view_size = 0;
+		size_t strings_view_size = 0;
+
+		void set_view() {
+			node_view = nodes.data();
+			children_view = children.data();
+			parents_view = parents.data();
+			shapes_view = shapes.data();
+			shape_keys_view = shape_keys.data();
+			shape_index_view = shape_index.data();
+			node_view_size = nodes.size();
+			children_view_size = children.size();
+			shapes_view_size = shapes.size();
+			shape_keys_view_size = shape_keys.size();
+			shape_index_view_size = shape_index.size();
+			strings = string_table.data();
+			strings_view_size = string_table.size();
+		}
+
+		// snapshot file header, sections follow in order of counts, 8 byte aligned.
+		class SnapshotHeader {
+		public:
+			char magic[8];
+			uint32_t version;
+			uint32_t endian; // 0x01020304
+			uint32_t node_size; // sizeof(FrozenNode)
+			uint32_t shape_size; // sizeof(FrozenShape)
+			uint64_t node_count;
+			uint64_t children_count;
+			uint64_t parents_count;
+			uint64_t shape_count;
+			uint64_t shape_key_count;
+			uint64_t shape_index_count;
+			uint64_t strings_size;
+			uint64_t file_size;
+		};
+
+		inline static const char snapshot_magic[8] = { 'C', 'L', 'A', 'U', 'J', 'S', 'N', 'P' };
+		inline static const uint32_t snapshot_version = 2;
+
+		static uint64_t Align8(uint64_t x) { return (x + 7) & ~uint64_t(7); }
+
+		friend class FrozenType;
+
+		// part of tape, one container(expanded) or some sibling values(run).
+		class Unit {
+		public:
+			uint64_t start = 0; // [start, last) of tape
+			uint64_t last = 0;
+			uint32_t key = FrozenNode::npos; // expanded only
+			uint32_t parent = 0; // unit idx of parent.
+			uint32_t offset = 0; // first position in parent`s children.
+			uint32_t value_count = 0; // run only, number of values of parent level.
+			uint32_t child_count = 0; // expanded only.
+			bool expanded = false;
+
+			uint64_t node_count = 1;
+			uint64_t node_base = 0;
+			uint64_t child_base = 0;
+		};
+
+		static uint64_t Next(const uint64_t* tape, uint64_t i) {
+			switch (uint8_t(tape[i] >> 56)) {
+			case '{':
+			case '[':
+				return uint32_t(tape[i] & simdjson::internal::JSON_VALUE_MASK);
+			case 'l':
+			case 'u':
+			case 'd':
+				return i + 2;
+			default:
+				return i + 1;
+			}
+		}
+
+		static uint32_t ChildCount(const uint64_t* tape, uint64_t i) {
+			uint32_t count = uint32_t((tape[i] >> 32) & simdjson::internal::JSON_COUNT_MASK);
+
+			if (count == simdjson::internal::JSON_COUNT_MASK) { // saturated
+				count = 0;
+				const uint64_t end = Next(tape, i) - 1;
+				for (uint64_t x = i + 1; x < end; x = Next(tape, x)) {
+					if (uint8_t(tape[x] >> 56) == 'k') {
+						++x;
+					}
+					++count;
+				}
+			}
+
+			return count;
+		}
+
+		// children of container of unit `me`, tape [first, end)
+		static void Split(const uint64_t* tape, uint32_t me, uint64_t first, uint64_t end, uint64_t min_len, int depth, std::vector<Unit>& units) {
+			uint32_t count = 0;
+			Unit run;
+			bool has_run = false;
+
+			for (uint64_t i = first; i < end; ) {
+				uint64_t v = i;
+				uint32_t key = FrozenNode::npos;
+
+				if (uint8_t(tape[i] >> 56) == 'k') {
+					key = uint32_t(tape[i] & simdjson::internal::JSON_VALUE_MASK);
+					v = i + 1;
+				}
+
+				const uint64_t after = Next(tape, v);
+				const uint8_t type = uint8_t(tape[v] >> 56);
+
+				if ((type == '{' || type == '[') && after - v >= min_len && depth < 64) {
+					if (has_run) {
+						units.push_back(run);
+						has_run = false;
+					}
+
+					Unit unit;
+					unit.expanded = true;
+					unit.start = v;
+					unit.last = after;
+					unit.key = key;
+					unit.parent = me;
+					unit.offset = count;
+
+					const uint32_t idx = units.size();
+					units.push_back(unit);
+
+					Split(tape, idx, v + 1, after - 1, min_len, depth + 1, units);
+				}
+				else {
+					if (!has_run) {
+						run = Unit();
+						run.start = i;
+						run.parent = me;
+						run.offset = count;
+						has_run = true;
+					}
+					run.last = after;
+					run.value_count++;
+
+					if (run.last - run.start >= min_len) {
+						units.push_back(run);
+						has_run = false;
+					}
+				}
+
+				++count;
+				i = after;
+			}
+
+			if (has_run) {
+				units.push_back(run);
+			}
+
+			units[me].child_count = count;
+		}
+
+		static uint64_t CountNode(const uint64_t* tape, const Unit& unit) {
+			uint64_t count = 0;
+			for (uint64_t i = unit.start; i < unit.last; ++i) {
+				switch (uint8_t(tape[i] >> 56)) {
+				case 'k':
+				case '}':
+				case ']':
+					break;
+				case 'l':
+				case 'u':
+				case 'd':
+					++i;
+					++count;
+					break;
+				default:
+					++count;
+					break;
+				}
+			}
+			return count;
+		}
+
+		void Fill(const uint64_t* tape, const std::vector<Unit>& units, size_t unit_idx) {
+			const Unit& unit = units[unit_idx];
+			const Unit& parent = units[unit.parent];
+
+			if (unit.expanded) {
+				FrozenNode& node = nodes[unit.node_base];
+				node.type = unit_idx == 0 ? 'r' : uint8_t(tape[unit.start] >> 56);
+				node.key = unit.key;
+				node.payload = unit.child_base | (uint64_t(unit.child_count) << 32);
+
+				if (unit_idx != 0) {
+					children[parent.child_base + unit.offset] = uint32_t(unit.node_base);
+					parents[unit.node_base] = uint32_t(parent.node_base);
+				}
+				else {
+					parents[unit.node_base] = FrozenNode::npos;
+				}
+				return;
+			}
+
+			uint64_t node_idx = unit.node_base;
+			uint64_t child_idx = unit.child_base;
+			uint64_t parent_idx = parent.child_base + unit.offset;
+			uint32_t key = FrozenNode::npos;
+
+			std::vector<std::pair<uint32_t, uint64_t>> _stack; // open containers, (node, next child position)
+
+			for (uint64_t i = unit.start; i < unit.last; ++i) {
+				const uint8_t type = uint8_t(tape[i] >> 56);
+				const uint64_t payload = tape[i] & simdjson::internal::JSON_VALUE_MASK;
+
+				if (type == 'k') {
+					key = uint32_t(payload);
+					continue;
+				}
+				if (type == '}' || type == ']') {
+					_stack.pop_back();
+					continue;
+				}
+
+				FrozenNode& node = nodes[node_idx];
+				node.type = type;
+				node.key = key;
+				key = FrozenNode::npos;
+
+				if (_stack.empty()) {
+					children[parent_idx++] = uint32_t(node_idx);
+					parents[node_idx] = uint32_t(parent.node_base);
+				}
+				else {
+					children[_stack.back().second++] = uint32_t(node_idx);
+					parents[node_idx] = _stack.back().first;
+				}
+
+				switch (type) {
+				case '{':
+				case '[':
+				{
+					const uint32_t count = ChildCount(tape, i);
+					node.payload = child_idx | (uint64_t(count) << 32);
+					_stack.push_back({ uint32_t(node_idx), child_idx });
+					child_idx += count;
+				}
+				break;
+				case 'l':
+				case 'u':
+				case 'd':
+					node.payload = tape[i + 1];
+					++i;
+					break;
+				case '"':
+					node.payload = payload;
+					break;
+				default:
+					node.payload = 0;
+					break;
+				}
+
+				++node_idx;
+			}
+		}
+
+		std::string_view get_str(uint64_t offset) const {
+			uint32_t len;
+			std::memcpy(&len, strings + offset, sizeof(uint32_t));
+			return std::string_view(reinterpret_cast<const char*>(strings + offset + sizeof(uint32_t)), len);
+		}
+
+		// to string_table, returns offset.
+		uint64_t AddString(std::string_view str) {
+			const uint64_t offset = string_table.size();
+			const uint32_t len = uint32_t(str.size());
+
+			string_table.resize(offset + sizeof(uint32_t) + len + 1);
+			std::memcpy(string_table.data() + offset, &len, sizeof(uint32_t));
+			std::memcpy(string_table.data() + offset + sizeof(uint32_t), str.data(), len);
+			string_table[offset + sizeof(uint32_t) + len] = 0;
+
+			return offset;
+		}
+
+		// keys - key offsets in strings, returns shape id. ( 0 - no shape )
+		uint32_t AddShape(const std::vector<uint32_t>& keys, std::map<std::vector<uint32_t>, uint32_t>& shape_table) {
+			if (keys.empty()) {
+				return 0;
+			}
+			if (shapes.empty()) {
+				shapes.push_back(FrozenShape());
+			}
+
+			auto x = shape_table.find(keys);
+			if (x != shape_table.end()) {
+				return x->second;
+			}
+			if (shapes.size() > FrozenNode::max_shape) {
+				return 0;
+			}
+
+			FrozenShape shape;
+			shape.first_key = uint32_t(shape_keys.size());
+			shape.key_count = uint32_t(keys.size());
+			shape_keys.insert(shape_keys.end(), keys.begin(), keys.end());
+
+			const uint32_t id = uint32_t(shapes.size());
+			shapes.push_back(shape);
+			shape_table.insert({ keys, id });
+			return id;
+		}
+
+		// key -> slot tables of all shapes, keys are in string_table. first key wins if keys are same.
+		void BuildShapeIndex() {
+			shape_index.clear();
+
+			for (size_t i = 1; i < shapes.size(); ++i) {
+				FrozenShape& shape = shapes[i];
+
+				uint32_t size = 2;
+				while (size < 2 * shape.key_count) {
+					size *= 2;
+				}
+				shape.first_index = uint32_t(shape_index.size());
+				shape.index_mask = size - 1;
+				shape_index.resize(shape_index.size() + size, FrozenNode::npos);
+
+				uint32_t* index = shape_index.data() + shape.first_index;
+				for (uint32_t j = 0; j < shape.key_count; ++j) {
+					const uint32_t key = shape_keys[shape.first_key + j];
+					uint32_t len;
+					std::memcpy(&len, string_table.data() + key, sizeof(uint32_t));
+					const std::string_view str(reinterpret_cast<const char*>(string_table.data() + key + sizeof(uint32_t)), len);
+
+					uint32_t h = FrozenShape::Hash(str) & shape.index_mask;
+					while (index[h] != FrozenNode::npos && shape_keys[shape.first_key + index[h]] != key) {
+						h = (h + 1) & shape.index_mask;
+					}
+					if (index[h] == FrozenNode::npos) {
+						index[h] = j;
+					}
+				}
+			}
+		}
+
+		// strings in string_buf -> string_table, keys are shared and objects get shapes.
+		//  node_group - [node_group[t], node_group[t + 1]) for thread t.
+		bool Compact(const std::vector<uint64_t>& node_group) {
+			const size_t thr_num = node_group.size() - 1;
+
+			// thread local keys and shapes.
+			class Local {
+			public:
+				std::unordered_map<std::string_view, uint32_t> key_table;
+				std::vector<std::string_view> keys;
+				std::map<std::vector<uint32_t>, uint32_t> shape_table;
+				std::vector<const std::vector<uint32_t>*> shapes;
+				uint64_t value_bytes = 0;
+
+				std::vector<uint32_t> key_offset; // local key -> offset in string_table
+				std::vector<uint32_t> shape_id; // local shape -> shape id
+				uint64_t value_base = 0;
+			};
+			std::vector<Local> local(thr_num);
+
+			// 1. keys of children -> local key, objects -> local shape + 1.
+			{
+				std::vector<std::future<void>> thr(thr_num);
+				for (size_t t = 0; t < thr_num; ++t) {
+					thr[t] = std::async(std::launch::async, [this, &local, &node_group](size_t t) {
+						Local& x = local[t];
+						std::vector<uint32_t> seq;
+
+						for (uint64_t i = node_group[t]; i < node_group[t + 1]; ++i) {
+							FrozenNode& node = nodes[i];
+
+							if (node.type == '"') {
+								x.value_bytes += sizeof(uint32_t) + get_str(node.payload).size() + 1;
+							}
+							else if (node.type == '{') {
+								seq.clear();
+								for (uint32_t j = 0; j < node.child_count(); ++j) {
+									FrozenNode& child = nodes[children[node.first_child() + j]];
+									std::string_view key = get_str(child.key);
+
+									auto it = x.key_table.find(key);
+									if (it == x.key_table.end()) {
+										it = x.key_table.insert({ key, uint32_t(x.keys.size()) }).first;
+										x.keys.push_back(key);
+									}
+									child.key = it->second;
+									seq.push_back(it->second);
+								}
+
+								node.shape = 0;
+								if (!seq.empty()) {
+									auto it = x.shape_table.find(seq);
+									if (it == x.shape_table.end()) {
+										it = x.shape_table.insert({ seq, uint32_t(x.shapes.size()) }).first;
+										x.shapes.push_back(&it->first);
+									}
+									if (it->second < FrozenNode::max_shape) {
+										node.shape = it->second + 1;
+									}
+								}
+							}
+						}
+					}, t);
+				}
+				for (size_t t = 0; t < thr_num; ++t) {
+					thr[t].get();
+				}
+			}
+
+			// 2. global keys and shapes, keys are first in string_table.
+			{
+				std::unordered_map<std::string_view, uint32_t> key_table;
+				std::map<std::vector<uint32_t>, uint32_t> shape_table;
+
+				for (size_t t = 0; t < thr_num; ++t) {
+					Local& x = local[t];
+					x.key_offset.resize(x.keys.size());
+					for (size_t i = 0; i < x.keys.size(); ++i) {
+						auto it = key_table.find(x.keys[i]);
+						if (it == key_table.end()) {
+							if (string_table.size() >= FrozenNode::npos) {
+								return false;
+							}
+							it = key_table.insert({ x.keys[i], uint32_t(AddString(x.keys[i])) }).first;
+						}
+						x.key_offset[i] = it->second;
+					}
+				}
+
+				std::vector<uint32_t> seq;
+				for (size_t t = 0; t < thr_num; ++t) {
+					Local& x = local[t];
+					x.shape_id.resize(x.shapes.size());
+					for (size_t i = 0; i < x.shapes.size(); ++i) {
+						seq.clear();
+						for (uint32_t key : *x.shapes[i]) {
+							seq.push_back(x.key_offset[key]);
+						}
+						x.shape_id[i] = AddShape(seq, shape_table);
+					}
+				}
+				BuildShapeIndex();
+
+				uint64_t sum = string_table.size();
+				for (size_t t = 0; t < thr_num; ++t) {
+					local[t].value_base = sum;
+					sum += local[t].value_bytes;
+				}
+				string_table.resize(sum);
+			}
+
+			// 3. remap keys and shapes, copy strings.
+			{
+				std::vector<std::future<void>> thr(thr_num);
+				for (size_t t = 0; t < thr_num; ++t) {
+					thr[t] = std::async(std::launch::async, [this, &local, &node_group](size_t t) {
+						Local& x = local[t];
+						uint64_t offset = x.value_base;
+
+						for (uint64_t i = node_group[t]; i < node_group[t + 1]; ++i) {
+							FrozenNode& node = nodes[i];
+
+							if (node.type == '"') {
+								std::string_view str = get_str(node.payload);
+								const uint32_t len = uint32_t(str.size());
+
+								std::memcpy(string_table.data() + offset, &len, sizeof(uint32_t));
+								std::memcpy(string_table.data() + offset + sizeof(uint32_t), str.data(), len);
+								string_table[offset + sizeof(uint32_t) + len] = 0;
+
+								node.payload = offset;
+								offset += sizeof(uint32_t) + len + 1;
+							}
+							else if (node.type == '{') {
+								if (node.shape != 0) {
+									node.shape = x.shape_id[node.shape - 1];
+								}
+								for (uint32_t j = 0; j < node.child_count(); ++j) {
+									FrozenNode& child = nodes[children[node.first_child() + j]];
+									child.key = node.shape != 0 ? j : x.key_offset[child.key]; // slot, key is in shape.
+								}
+							}
+						}
+					}, t);
+				}
+				for (size_t t = 0; t < thr_num; ++t) {
+					thr[t].get();
+				}
+			}
+
+			parser.reset();
+			set_view();
+
+			return true;
+		}
+
+	public:
+		FrozenDocument() { }
+
+		FrozenDocument(const FrozenDocument&) = delete;
+		FrozenDocument& operator=(const FrozenDocument&) = delete;
+		FrozenDocument(FrozenDocument&&) = default;
+		FrozenDocument& operator=(FrozenDocument&&) = default;
+
+		// root, like UserType ( type -1 ), has one child.
+		FrozenType root() const { return FrozenType(this, 0); }
+
+		size_t node_count() const { return node_view_size; }
+
+		size_t shape_count() const { return shapes_view_size == 0 ? 0 : shapes_view_size - 1; }
+
+		bool is_snapshot() const { return snapshot.is_open(); }
+
+		void clear() {
+			nodes.clear();
+			children.clear();
+			parents.clear();
+			shapes.clear();
+			shape_keys.clear();
+			shape_index.clear();
+			parser.reset();
+			string_table.clear();
+			snapshot.close();
+			set_view();
+		}
+
+		// parser - loaded, strings are copied to string_table and parser is released after build.
+		bool Build(std::unique_ptr<simdjson::dom::parser>&& _parser, int thr_num) {
+			clear();
+
+			parser = std::move(_parser);
+			strings = parser->raw_string_buf().get();
+
+			if (thr_num <= 0) {
+				thr_num = std::thread::hardware_concurrency();
+			}
+			if (thr_num <= 0) {
+				thr_num = 1;
+			}
+
+			const uint64_t* tape = parser->raw_tape().get();
+			if (uint8_t(tape[0] >> 56) != 'r') {
+				return false;
+			}
+			const uint64_t length = tape[0] & simdjson::internal::JSON_VALUE_MASK; // right after last 'r'
+
+			// 1. split tape.
+			std::vector<Unit> units;
+			{
+				uint64_t min_len = length / (uint64_t(thr_num) * 8);
+				if (min_len < 4096) {
+					min_len = 4096;
+				}
+
+				Unit root;
+				root.expanded = true;
+				root.start = 0;
+				root.last = length;
+				units.push_back(root);
+
+				Split(tape, 0, 1, length - 1, min_len, 0, units);
+			}
+
+			// group of units for each thread.
+			std::vector<size_t> group(1, 0);
+			{
+				const uint64_t len = length / thr_num + 1;
+				uint64_t sum = 0;
+				for (size_t i = 0; i < units.size(); ++i) {
+					if (!units[i].expanded) {
+						sum += units[i].last - units[i].start;
+					}
+					if (sum >= len) {
+						group.push_back(i + 1);
+						sum = 0;
+					}
+				}
+				if (group.back() != units.size()) {
+					group.push_back(units.size());
+				}
+			}
+
+			// 2. count nodes, parallel.
+			{
+				std::vector<std::future<void>> thr(group.size() - 1);
+				for (size_t t = 0; t < thr.size(); ++t) {
+					thr[t] = std::async(std::launch::async, [&units, tape](size_t start, size_t last) {
+						for (size_t i = start; i < last; ++i) {
+							if (!units[i].expanded) {
+								units[i].node_count = CountNode(tape, units[i]);
+							}
+						}
+					}, group[t], group[t + 1]);
+				}
+				for (size_t t = 0; t < thr.size(); ++t) {
+					thr[t].get();
+				}
+			}
+
+			// 3. assign nodes, children.
+			uint64_t node_count = 0;
+			uint64_t child_count = 0;
+			for (size_t i = 0; i < units.size(); ++i) {
+				units[i].node_base = node_count;
+				units[i].child_base = child_count;
+				node_count += units[i].node_count;
+				child_count += units[i].expanded ? units[i].child_count : units[i].node_count - units[i].value_count;
+			}
+
+			if (node_count >= FrozenNode::npos) {
+				std::cout << "too many nodes for FrozenDocument\n";
+				clear();
+				return false;
+			}
+
+			nodes.resize(node_count);
+			children.resize(child_count);
+			parents.resize(node_count);
+
+			// 4. fill, parallel.
+			{
+				std::vector<std::future<void>> thr(group.size() - 1);
+				for (size_t t = 0; t < thr.size(); ++t) {
+					thr[t] = std::async(std::launch::async, [this, &units, tape](size_t start, size_t last) {
+						for (size_t i = start; i < last; ++i) {
+							Fill(tape, units, i);
+						}
+					}, group[t], group[t + 1]);
+				}
+				for (size_t t = 0; t < thr.size(); ++t) {
+					thr[t].get();
+				}
+			}
+
+			// 5. shapes, own strings.
+			{
+				std::vector<uint64_t> node_group;
+				for (size_t t = 0; t + 1 < group.size(); ++t) {
+					node_group.push_back(units[group[t]].node_base);
+				}
+				node_group.push_back(nodes.size());
+
+				if (!Compact(node_group)) {
+					std::cout << "too many strings for FrozenDocument\n";
+					clear();
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		// UserType tree -> FrozenDocument, strings are copied to string_table. ( keys are shared )
+		bool Freeze(const UserType& ut) {
+			clear();
+
+			std::unordered_map<std::string_view, uint32_t> key_table; // keys are in ut.
+
+			auto add_key = [&](const ItemType& value) -> uint32_t {
+				if (!value.key.is_key || !value.key.get_str_val()) {
+					return FrozenNode::npos;
+				}
+				const std::string& key = *value.key.get_str_val();
+
+				auto x = key_table.find(key);
+				if (x != key_table.end()) {
+					return x->second;
+				}
+				if (string_table.size() >= FrozenNode::npos) {
+					return FrozenNode::npos; // checked in loop.
+				}
+				const uint32_t offset = uint32_t(AddString(key));
+				key_table.insert({ std::string_view(key), offset });
+				return offset;
+			};
+
+			auto set_value = [&](FrozenNode& node, const Data& data) {
+				node.type = uint8_t(data.type);
+
+				switch (data.type) {
+				case simdjson::internal::tape_type::STRING:
+					node.payload = AddString(*data.get_str_val());
+					break;
+				case simdjson::internal::tape_type::INT64:
+					std::memcpy(&node.payload, &data.int_val, sizeof(uint64_t));
+					break;
+				case simdjson::internal::tape_type::UINT64:
+					node.payload = data.uint_val;
+					break;
+				case simdjson::internal::tape_type::DOUBLE:
+					std::memcpy(&node.payload, &data.float_val, sizeof(uint64_t));
+					break;
+				default:
+					break;
+				}
+			};
+
+			auto add_node = [&](const UserType* x, uint32_t parent) -> uint32_t {
+				const uint32_t idx = uint32_t(nodes.size());
+				FrozenNode node;
+
+				node.key = add_key(x->get_value());
+
+				if (x->is_root() || x->is_user_type()) {
+					const uint64_t first = children.size();
+					const size_t count = x->is_packed() ? x->get_packed_size() : x->get_data_size();
+					node.type = x->is_root() ? 'r' : x->is_object() ? '{' : '[';
+					node.payload = first | (uint64_t(count) << 32);
+					children.resize(first + count);
+				}
+				else {
+					set_value(node, x->get_value().data);
+				}
+
+				nodes.push_back(node);
+				parents.push_back(parent);
+				return idx;
+			};
+
+
+			class Open {
+			public:
+				const UserType* ut;
+				uint32_t idx; // node idx
+				size_t i; // next child
+			};
+			std::vector<Open> _stack; // pre-order.
+
+			_stack.push_back(Open{ &ut, add_node(&ut, FrozenNode::npos), 0 });
+
+			while (!_stack.empty()) {
+				Open& top = _stack.back();
+
+				if (nodes.size() >= FrozenNode::npos || string_table.size() >= FrozenNode::npos) {
+					std::cout << "too many nodes for FrozenDocument\n";
+					clear();
+					return false;
+				}
+
+				if (top.ut->is_packed()) {
+					const uint64_t first = nodes[top.idx].first_child();
+
+					for (size_t i = 0; i < top.ut->get_packed_size(); ++i) {
+						FrozenNode node;
+						set_value(node, top.ut->get_packed_data(i));
+
+						children[first + i] = uint32_t(nodes.size());
+						nodes.push_back(node);
+						parents.push_back(top.idx);
+					}
+
+					_stack.pop_back();
+					continue;
+				}
+
+				if (top.i == top.ut->get_data_size()) {
+					_stack.pop_back();
+					continue;
+				}
+
+				const UserType* child = top.ut->get_data_list(top.i);
+				const uint32_t child_idx = add_node(child, top.idx);
+
+				children[nodes[top.idx].first_child() + top.i] = child_idx;
+				++top.i;
+
+				if (child->is_user_type()) {
+					_stack.push_back(Open{ child, child_idx, 0 });
+				}
+			}
+
+			// shapes
+			std::map<std::vector<uint32_t>, uint32_t> shape_table;
+			std::vector<uint32_t> seq;
+			for (size_t i = 0; i < nodes.size(); ++i) {
+				if (nodes[i].type == '{') {
+					seq.clear();
+					for (uint32_t j = 0; j < nodes[i].child_count(); ++j) {
+						seq.push_back(nodes[children[nodes[i].first_child() + j]].key);
+					}
+					nodes[i].shape = std::find(seq.begin(), seq.end(), FrozenNode::npos) == seq.end() ? AddShape(seq, shape_table) : 0;
+
+					if (nodes[i].shape != 0) { // slot, key is in shape.
+						for (uint32_t j = 0; j < nodes[i].child_count(); ++j) {
+							nodes[children[nodes[i].first_child() + j]].key = j;
+						}
+					}
+				}
+			}
+			BuildShapeIndex();
+
+			set_view();
+
+			return true;
+		}
+
+	private:
+		// string at offset is in strings.
+		bool CheckString(uint64_t offset) const {
+			if (offset > strings_view_size || strings_view_size - offset < sizeof(uint32_t)) {
+				return false;
+			}
+			uint32_t len;
+			std::memcpy(&len, strings + offset, sizeof(uint32_t));
+			return strings_view_size - offset - sizeof(uint32_t) > len; // and 0 at end.
+		}
+
+		// views of loaded snapshot are consistent : tree in pre-order with matching parents, offsets and indices in range,
+		//  shapes with free slot in index. one pass, O(nodes + shape keys + shape index).
+		bool CheckSnapshot() const {
+			if (node_view[0].type != 'r' || parents_view[0] != FrozenNode::npos) {
+				return false;
+			}
+
+			for (size_t s = 1; s < shapes_view_size; ++s) {
+				const FrozenShape& shape = shapes_view[s];
+				const uint64_t index_size = uint64_t(shape.index_mask) + 1;
+
+				if (uint64_t(shape.first_key) + shape.key_count > shape_keys_view_size ||
+					(index_size & shape.index_mask) != 0 || uint64_t(shape.first_index) + index_size > shape_index_view_size) {
+					return false;
+				}
+				for (uint32_t j = 0; j < shape.key_count; ++j) {
+					if (!CheckString(shape_keys_view[shape.first_key + j])) {
+						return false;
+					}
+				}
+				uint64_t empty = 0;
+				for (uint64_t j = 0; j < index_size; ++j) {
+					const uint32_t slot = shape_index_view[shape.first_index + j];
+					if (slot == FrozenNode::npos) {
+						++empty;
+					}
+					else if (slot >= shape.key_count) {
+						return false;
+					}
+				}
+				if (empty == 0) { // find would not stop.
+					return false;
+				}
+			}
+
+			for (size_t i = 0; i < node_view_size; ++i) {
+				const FrozenNode& node = node_view[i];
+
+				if (i > 0) {
+					if (node.type == 'r' || parents_view[i] >= i) { // pre-order, parent is before.
+						return false;
+					}
+					const FrozenNode& parent = node_view[parents_view[i]];
+					if (parent.shape != 0) {
+						if (node.key >= shapes_view[parent.shape].key_count) {
+							return false;
+						}
+					}
+					else if ((parent.type == '{' || node.key != FrozenNode::npos) && !CheckString(node.key)) { // object child has key.
+						return false;
+					}
+				}
+				if (node.shape != 0 && (node.type != '{' || node.shape >= shapes_view_size || node.child_count() != shapes_view[node.shape].key_count)) {
+					return false;
+				}
+
+				switch (node.type) {
+				case 'r':
+				case '{':
+				case '[':
+					if (uint64_t(node.first_child()) + node.child_count() > children_view_size) {
+						return false;
+					}
+					for (uint32_t j = 0; j < node.child_count(); ++j) {
+						const uint32_t child = children_view[node.first_child() + j];
+						if (child >= node_view_size || child <= i || parents_view[child] != i) {
+							return false;
+						}
+					}
+					break;
+				case '"':
+					if (!CheckString(node.payload)) {
+						return false;
+					}
+					break;
+				case 'l':
+				case 'u':
+				case 'd':
+				case 't':
+				case 'f':
+				case 'n':
+					break;
+				default:
+					return false;
+				}
+			}
+
+			return true;
+		}
+	public:
+
+		// FrozenDocument -> UserType tree under ut, to edit a frozen or snapshot document. ( Freeze is the reverse )
+		//  returns pool, all slots are used, so no blocks. ( PoolManager(pool, pool_size, {}) )
+		UserType* Thaw(int thr_num, UserType* ut, int64_t* pool_size = nullptr) const {
+			if (thr_num <= 0) {
+				thr_num = std::thread::hardware_concurrency();
+			}
+			if (thr_num <= 0) {
+				thr_num = 1;
+			}
+
+			int64_t count = 0;
+			UserType* pool = LoadData::thaw(*ut, *this, thr_num, count);
+			if (pool_size) {
+				*pool_size = count;
+			}
+			return pool;
+		}
+
+		// relocatable image, nodes hold offsets only, so it is written as is.
+		bool SaveSnapshot(const std::string& fileName) const {
+			if (node_view_size == 0) {
+				std::cout << "empty FrozenDocument\n";
+				return false;
+			}
+
+			SnapshotHeader header;
+			std::memset(&header, 0, sizeof(header));
+			std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+			header.version = snapshot_version;
+			header.endian = 0x01020304;
+			header.node_size = sizeof(FrozenNode);
+			header.shape_size = sizeof(FrozenShape);
+			header.node_count = node_view_size;
+			header.children_count = children_view_size;
+			header.parents_count = node_view_size;
+			header.shape_count = shapes_view_size;
+			header.shape_key_count = shape_keys_view_size;
+			header.shape_index_count = shape_index_view_size;
+			header.strings_size = strings_view_size;
+
+			const std::pair<const void*, uint64_t> section[] = {
+				{ node_view, header.node_count * sizeof(FrozenNode) },
+				{ children_view, header.children_count * sizeof(uint32_t) },
+				{ parents_view, header.parents_count * sizeof(uint32_t) },
+				{ shapes_view, header.shape_count * sizeof(FrozenShape) },
+				{ shape_keys_view, header.shape_key_count * sizeof(uint32_t) },
+				{ shape_index_view, header.shape_index_count * sizeof(uint32_t) },
+				{ strings, header.strings_size }
+			};
+
+			header.file_size = Align8(sizeof(header));
+			for (auto& x : section) {
+				header.file_size += Align8(x.second);
+			}
+
+			FILE* file = std::fopen(fileName.c_str(), "wb");
+			if (!file) {
+				std::cout << "file open error\n";
+				return false;
+			}
+
+			static const char zero[8] = { 0 };
+			bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+			ok = ok && std::fwrite(zero, 1, Align8(sizeof(header)) - sizeof(header), file) == Align8(sizeof(header)) - sizeof(header);
+			for (auto& x : section) {
+				if (!ok) {
+					break;
+				}
+				if (x.second > 0) {
+					ok = std::fwrite(x.first, 1, x.second, file) == x.second;
+				}
+				const uint64_t pad = Align8(x.second) - x.second;
+				ok = ok && std::fwrite(zero, 1, pad, file) == pad;
+			}
+			ok = (std::fclose(file) == 0) && ok;
+
+			if (!ok) {
+				std::cout << "file write error\n";
+			}
+			return ok;
+		}
+
+		// mmap and check header, no per node work. file must not be changed while loaded.
+		//  validate = false : file is trusted ( from SaveSnapshot ), broken file -> undefined behavior.
+		//  validate = true : CheckSnapshot, one pass over nodes, for files from elsewhere.
+		bool LoadSnapshot(const std::string& fileName, bool validate = false) {
+			clear();
+
+			if (!snapshot.open(fileName)) {
+				std::cout << "file open error\n";
+				return false;
+			}
+
+			const uint8_t* base = snapshot.data();
+			const uint64_t size = snapshot.size();
+
+			SnapshotHeader header;
+			if (size < sizeof(header)) {
+				std::cout << "not snapshot file\n";
+				clear();
+				return false;
+			}
+			std::memcpy(&header, base, sizeof(header));
+
+			if (std::memcmp(header.magic, snapshot_magic, sizeof(header.magic)) != 0) {
+				std::cout << "not snapshot file\n";
+				clear();
+				return false;
+			}
+			if (header.version != snapshot_version || header.endian != 0x01020304 ||
+				header.node_size != sizeof(FrozenNode) || header.shape_size != sizeof(FrozenShape)) {
+				std::cout << "snapshot version or platform mismatch\n";
+				clear();
+				return false;
+			}
+
+			// counts are from file, check overflow before multiply.
+			const uint64_t limit = size;
+			if (header.file_size != size || header.node_count == 0 || header.node_count > limit || header.children_count > limit ||
+				header.parents_count != header.node_count || header.shape_count > limit || header.shape_key_count > limit ||
+				header.shape_index_count > limit || header.strings_size > limit) {
+				std::cout << "broken snapshot file\n";
+				clear();
+				return false;
+			}
+
+			uint64_t offset = Align8(sizeof(header));
+			uint64_t section_offset[7];
+			const uint64_t section_size[7] = {
+				header.node_count * sizeof(FrozenNode),
+				header.children_count * sizeof(uint32_t),
+				header.parents_count * sizeof(uint32_t),
+				header.shape_count * sizeof(FrozenShape),
+				header.shape_key_count * sizeof(uint32_t),
+				header.shape_index_count * sizeof(uint32_t),
+				header.strings_size
+			};
+			for (int i = 0; i < 7; ++i) {
+				section_offset[i] = offset;
+				offset += Align8(section_size[i]);
+			}
+			if (offset != size) {
+				std::cout << "broken snapshot file\n";
+				clear();
+				return false;
+			}
+
+			// mmap is page aligned, sections are 8 byte aligned.
+			node_view = reinterpret_cast<const FrozenNode*>(base + section_offset[0]);
+			children_view = reinterpret_cast<const uint32_t*>(base + section_offset[1]);
+			parents_view = reinterpret_cast<const uint32_t*>(base + section_offset[2]);
+			shapes_view = reinterpret_cast<const FrozenShape*>(base + section_offset[3]);
+			shape_keys_view = reinterpret_cast<const uint32_t*>(base + section_offset[4]);
+			shape_index_view = reinterpret_cast<const uint32_t*>(base + section_offset[5]);
+			strings = base + section_offset[6];
+
+			node_view_size = header.node_count;
+			children_view_size = header.children_count;
+			shapes_view_size = header.shape_count;
+			shape_keys_view_size = header.shape_key_count;
+			shape_index_view_size = header.shape_index_count;
+			strings_view_size = header.strings_size;
+
+			if (validate && !CheckSnapshot()) {
+				std::cout << "broken snapshot file\n";
+				clear();
+				return false;
+			}
+
+			return true;
+		}
+	};
+
+	inline const FrozenNode& FrozenType::get_node() const {
+		return doc->node_view[idx];
+	}
+
+	inline FrozenType FrozenType::get_data_list(size_t idx) const {
+		return FrozenType(doc, doc->children_view[get_node().first_child() + idx]);
+	}
+
+	inline FrozenType FrozenType::get_parent() const {
+		return FrozenType(doc, doc->parents_view[idx]);
+	}
+
+	inline FrozenType FrozenType::find(std::string_view key) const {
+		if (!is_object()) {
+			return FrozenType();
+		}
+
+		const FrozenNode& node = get_node();
+		const uint32_t* child = doc->children_view + node.first_child();
+
+		if (node.shape != 0) { // key -> slot by index of shape, no access to children.
+			const FrozenShape& shape = doc->shapes_view[node.shape];
+			const uint32_t* shape_key = doc->shape_keys_view + shape.first_key;
+			const uint32_t* index = doc->shape_index_view + shape.first_index;
+
+			for (uint32_t h = FrozenShape::Hash(key) & shape.index_mask; index[h] != FrozenNode::npos; h = (h + 1) & shape.index_mask) {
+				if (doc->get_str(shape_key[index[h]]) == key) {
+					return FrozenType(doc, child[index[h]]);
+				}
+			}
+			return FrozenType();
+		}
+
+		for (uint32_t i = 0; i < node.child_count(); ++i) {
+			if (doc->get_str(doc->node_view[child[i]].key) == key) {
+				return FrozenType(doc, child[i]);
+			}
+		}
+		return FrozenType();
+	}
+
+	inline std::string_view FrozenType::get_key() const {
+		if (!has_key()) {
+			return std::string_view();
+		}
+
+		const FrozenNode& parent = doc->node_view[doc->parents_view[idx]];
+		if (parent.shape != 0) { // key is slot.
+			return doc->get_str(doc->shape_keys_view[doc->shapes_view[parent.shape].first_key + get_node().key]);
+		}
+		return doc->get_str(get_node().key);
+	}
+
+	inline std::string_view FrozenType::get_string() const {
+		return get_node().type == '"' ? doc->get_str(get_node().payload) : std::string_view();
+	}
+
+	inline ItemType FrozenType::get_value() const {
+		ItemType value;
+
+		if (has_key()) {
+			std::string_view key = get_key();
+			value.key.type = simdjson::internal::tape_type::STRING;
+			value.key.is_key = true;
+			value.key.set_str_val(key.data(), key.size());
+		}
+
+		if (is_item_type()) {
+			value.data.type = get_type();
+
+			switch (get_node().type) {
+			case '"':
+			{
+				std::string_view str = get_string();
+				value.data.set_str_val(str.data(), str.size());
+			}
+			break;
+			case 'l':
+				value.data.int_val = get_int64();
+				break;
+			case 'u':
+				value.data.uint_val = get_uint64();
+				break;
+			case 'd':
+				value.data.float_val = get_double();
+				break;
+			}
+		}
+
+		return value;
+	}
+
+	inline claujson::UserType* LoadData::thaw(class UserType& global, const FrozenDocument& doc, int thr_num, int64_t& pool_size) {
+		pool_size = 0;
+
+		const FrozenType root = doc.root();
+		if (doc.node_count() < 2 || !root.is_root()) {
+			std::cout << "empty FrozenDocument\n";
+			return nullptr;
+		}
+
+		const uint32_t node_count = uint32_t(doc.node_count());
+		claujson::UserType* pool = (claujson::UserType*)calloc(node_count - 1, sizeof(claujson::UserType));
+		pool_size = node_count - 1;
+
+		// nodes [start, last), each writes its own slot only.
+		auto build = [&global, &doc, pool](uint32_t start, uint32_t last) {
+			for (uint32_t i = start; i < last; ++i) {
+				const FrozenType x(&doc, i);
+				const int type = x.is_object() ? 0 : x.is_array() ? 1 : 4;
+
+				class UserType* ut = new (pool + (i - 1)) UserType(x.get_value(), type);
+				ut->alloc_type = PoolManager::Type::FROM_POOL;
+
+				const uint32_t parent = x.get_parent().get_idx();
+				ut->parent = parent == 0 ? &global : pool + (parent - 1);
+
+				if (type != 4) {
+					const size_t count = x.get_data_size();
+					ut->data.resize(count);
+					for (size_t j = 0; j < count; ++j) {
+						ut->data[j] = pool + (x.get_data_list(j).get_idx() - 1);
+					}
+				}
+			}
+		};
+
+		const uint32_t min_len = 1 << 15;
+		if (uint32_t(thr_num) > node_count / min_len) {
+			thr_num = int(node_count / min_len);
+		}
+
+		if (thr_num <= 1) {
+			build(1, node_count);
+		}
+		else {
+			std::vector<std::future<void>> thr(thr_num);
+			for (int t = 0; t < thr_num; ++t) {
+				const uint32_t start = 1 + uint32_t(uint64_t(node_count - 1) * t / thr_num);
+				const uint32_t last = 1 + uint32_t(uint64_t(node_count - 1) * (t + 1) / thr_num);
+				thr[t] = std::async(std::launch::async, build, start, last);
+			}
+			for (int t = 0; t < thr_num; ++t) {
+				thr[t].get();
+			}
+		}
+
+		for (size_t j = 0; j < root.get_data_size(); ++j) {
+			global.add_user_type(pool + (root.get_data_list(j).get_idx() - 1));
+		}
+
+		return pool;
+	}
+
+	// key of KeyPath, length is computed at compile time.
+	class PathKey {
+	public:
+		const char* str = nullptr;
+		uint32_t len = 0;
+
+		constexpr PathKey(const char* str) : str(str), len(length(str)) { }
+
+		static constexpr uint32_t length(const char* str) {
+			uint32_t len = 0;
+			while (str[len]) {
+				++len;
+			}
+			return len;
+		}
+
+		bool equal(std::string_view key) const {
+			return key.size() == len && std::memcmp(key.data(), str, len) == 0;
+		}
+
+		bool equal(const UserType* ut) const {
+			const Data& key = ut->get_value().key;
+			return key.is_key && key.get_str_val()->size() == len && std::memcmp(key.get_str_val()->data(), str, len) == 0;
+		}
+	};
+
+	// fixed path of keys, for same-layout objects looked up many times.
+	//  static const claujson::KeyPath street("properties", "STREET");  street.find(ut) == ut->find("properties")->find("STREET")
+	//  each step remembers the index of the last matched child, so next lookup is one compare if layout is same.
+	//  ( UserType::find and FrozenType::find do not hash, so compile time part is key length. )
+	template <size_t N>
+	class KeyPath {
+	private:
+		PathKey keys[N];
+		mutable std::atomic<uint32_t> hint[N]; // only hint, relaxed.
+	public:
+		template <class... T>
+		constexpr KeyPath(const T&... key) : keys{ PathKey(key)... }, hint{} {
+			static_assert(sizeof...(T) == N, "KeyPath, number of keys");
+		}
+
+		KeyPath(const KeyPath&) = delete;
+		KeyPath& operator=(const KeyPath&) = delete;
+
+		constexpr size_t size() const { return N; }
+		constexpr const PathKey& get_key(size_t k) const { return keys[k]; }
+
+		// nullptr if not found.
+		UserType* find(UserType* ut) const {
+			for (size_t k = 0; k < N && ut; ++k) {
+				if (!ut->is_object()) {
+					return nullptr;
+				}
+
+				const uint32_t n = (uint32_t)ut->get_data_size();
+				uint32_t i = hint[k].load(std::memory_order_relaxed);
+
+				if (i < n && keys[k].equal(ut->get_data_list(i))) {
+					ut = ut->get_data_list(i);
+					continue;
+				}
+
+				UserType* next = nullptr;
+				for (i = 0; i < n; ++i) {
+					if (keys[k].equal(ut->get_data_list(i))) {
+						hint[k].store(i, std::memory_order_relaxed);
+						next = ut->get_data_list(i);
+						break;
+					}
+				}
+				ut = next;
+			}
+			return ut;
+		}
+
+		const UserType* find(const UserType* ut) const {
+			return find(const_cast<UserType*>(ut));
+		}
+
+		// not valid() if not found.
+		FrozenType find(FrozenType x) const {
+			for (size_t k = 0; k < N && x.valid(); ++k) {
+				if (!x.is_object()) {
+					return FrozenType();
+				}
+
+				const uint32_t n = (uint32_t)x.get_data_size();
+				uint32_t i = hint[k].load(std::memory_order_relaxed);
+
+				if (i < n) {
+					FrozenType child = x.get_data_list(i);
+					if (keys[k].equal(child.get_key())) {
+						x = child;
+						continue;
+					}
+				}
+
+				FrozenType next;
+				for (i = 0; i < n; ++i) {
+					FrozenType child = x.get_data_list(i);
+					if (keys[k].equal(child.get_key())) {
+						hint[k].store(i, std::memory_order_relaxed);
+						next = child;
+						break;
+					}
+				}
+				x = next;
+			}
+			return x;
+		}
+	};
+
+	template <class... T>
+	KeyPath(const T&...) -> KeyPath<sizeof...(T)>;
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+	// string literal as template argument. ( C++20 )
+	template <size_t N>
+	class FixedString {
+	public:
+		char str[N] = {};
+
+		constexpr FixedString(const char(&s)[N]) {
+			for (size_t i = 0; i < N; ++i) {
+				str[i] = s[i];
+			}
+		}
+	};
+
+	// claujson::path<"properties", "STREET">.find(ut), one KeyPath ( and its hints ) per path.
+	template <FixedString... Keys>
+	inline const KeyPath<sizeof...(Keys)> path{ Keys.str... };
+#endif
+
+	// key -> member of T, see Binding.
+	template <class T, class M>
+	class Field {
+	public:
+		PathKey key;
+		M T::* member;
+
+		constexpr Field(const char* key, M T::* member) : key(key), member(member) { }
+	};
+
+	template <class T, class M>
+	constexpr Field<T, M> field(const char* key, M T::* member) {
+		return Field<T, M>(key, member);
+	}
+
+	// fields of T for Deserialize, specialize with CLAUJSON_BINDING. ( at global scope )
+	//  CLAUJSON_BINDING(Lot, claujson::field("BLKLOT", &Lot::blklot), CLAUJSON_FIELD(Lot, STREET))
+	//  member can be bool, number, std::string, std::vector of them, or other bound struct.
+	template <class T>
+	class Binding {
+	public:
+		static constexpr bool value = false;
+	};
+
+#define CLAUJSON_FIELD(type, member) claujson::field(#member, &type::member)
+#define CLAUJSON_BINDING(type, ...) \
+	template <> class claujson::Binding<type> { \
+	public: \
+		static constexpr bool value = true; \
+		static constexpr auto fields() { return std::make_tuple(__VA_ARGS__); } \
+	};
+
+	template <class T>
+	class is_vector : public std::false_type { };
+	template <class T, class A>
+	class is_vector<std::vector<T, A>> : public std::true_type { };
+
+	template <class T>
+	class dependent_false : public std::false_type { };
+
+	// tape -> T, no UserType. unknown keys are skipped by jump offset. null -> member is not changed.
+	class TapeReader {
+	private:
+		const uint64_t* tape;
+		const uint8_t* string_buf;
+	public:
+		TapeReader(const uint64_t* tape, const uint8_t* string_buf) : tape(tape), string_buf(string_buf) { }
+
+		uint8_t type(uint64_t i) const {
+			return uint8_t(tape[i] >> 56);
+		}
+
+		std::string_view get_str(uint64_t i) const {
+			const uint64_t payload = tape[i] & simdjson::internal::JSON_VALUE_MASK;
+			uint32_t len;
+			std::memcpy(&len, string_buf + payload, sizeof(uint32_t));
+			return std::string_view(reinterpret_cast<const char*>(string_buf + payload + sizeof(uint32_t)), len);
+		}
+
+		// next value.
+		uint64_t next(uint64_t i) const {
+			switch (type(i)) {
+			case '{':
+			case '[':
+				return uint32_t(tape[i] & simdjson::internal::JSON_VALUE_MASK);
+			case 'l':
+			case 'u':
+			case 'd':
+				return i + 2;
+			}
+			return i + 1;
+		}
+
+		// integer of tape fits in integral T.
+		template <class T>
+		static bool fits(int64_t v) {
+			if (v < 0) {
+				return std::is_signed_v<T> && v >= int64_t(std::numeric_limits<T>::min());
+			}
+			return uint64_t(v) <= uint64_t(std::numeric_limits<T>::max());
+		}
+		template <class T>
+		static bool fits(uint64_t v) {
+			return v <= uint64_t(std::numeric_limits<T>::max());
+		}
+
+		// value at tape[i] -> x, i is moved to next value. false if type is not matched or integer is out of range of T.
+		template <class T>
+		bool read(uint64_t& i, T& x) const {
+			const uint8_t t = type(i);
+
+			if (t == 'n') {
+				++i;
+				return true;
+			}
+
+			if constexpr (std::is_same_v<T, bool>) {
+				if (t != 't' && t != 'f') {
+					return false;
+				}
+				x = t == 't';
+				++i;
+				return true;
+			}
+			else if constexpr (std::is_arithmetic_v<T>) {
+				switch (t) {
+				case 'l':
+					if constexpr (std::is_integral_v<T>) {
+						if (!fits<T>(int64_t(tape[i + 1]))) {
+							return false;
+						}
+					}
+					x = static_cast<T>(int64_t(tape[i + 1]));
+					break;
+				case 'u':
+					if constexpr (std::is_integral_v<T>) {
+						if (!fits<T>(tape[i + 1])) {
+							return false;
+						}
+					}
+					x = static_cast<T>(tape[i + 1]);
+					break;
+				case 'd':
+					if constexpr (std::is_floating_point_v<T>) {
+						double val;
+						std::memcpy(&val, &tape[i + 1], sizeof(double));
+						x = static_cast<T>(val);
+						break;
+					}
+					else {
+						return false;
+					}
+				default:
+					return false;
+				}
+				i += 2;
+				return true;
+			}
+			else if constexpr (std::is_same_v<T, std::string>) {
+				if (t != '"') {
+					return false;
+				}
+				x = get_str(i);
+				++i;
+				return true;
+			}
+			else if constexpr (is_vector<T>::value) {
+				if (t != '[') {
+					return false;
+				}
+				const uint64_t end = uint32_t(tape[i] & simdjson::internal::JSON_VALUE_MASK);
+				x.clear();
+				x.reserve(((tape[i] & simdjson::internal::JSON_VALUE_MASK) >> 32) & simdjson::internal::JSON_COUNT_MASK);
+				for (++i; i < end - 1;) {
+					typename T::value_type elem{};
+					if (!read(i, elem)) {
+						return false;
+					}
+					x.push_back(std::move(elem));
+				}
+				i = end;
+				return true;
+			}
+			else if constexpr (Binding<T>::value) {
+				if (t != '{') {
+					return false;
+				}
+				const uint64_t end = uint32_t(tape[i] & simdjson::internal::JSON_VALUE_MASK);
+				constexpr auto fields = Binding<T>::fields();
+
+				for (++i; i < end - 1;) {
+					const std::string_view key = get_str(i);
+					bool found = false;
+					bool ok = true;
+
+					++i;
+					std::apply([&](const auto&... f) {
+						((!found && f.key.equal(key) ? (found = true, ok = read(i, x.*(f.member))) : false), ...);
+					}, fields);
+
+					if (!ok) {
+						return false;
 					}
-					else if (count < thr_num && tape_idx == start[count] + 1) {
-						start[count] = tape_idx;
-						count++;
+					if (!found) {
+						i = next(i);
 					}
+				}
+				i = end;
+				return true;
+			}
+			else {
+				static_assert(dependent_false<T>::value, "TapeReader, no Binding for type");
+				return false;
+			}
+		}
 
-					tape_val = tape[tape_idx];
-					payload = tape_val & simdjson::internal::JSON_VALUE_MASK;
-					type = uint8_t(tape_val >> 56);
+		// JSON Pointer ( no "*" ) -> tape index, 0 if not found.
+		uint64_t locate(std::string_view pointer) const {
+			uint64_t i = 1;
+			size_t pos = 0;
 
-					switch (type) {
-					case 'l':
-					case 'u':
-					case 'd':
-						tape_idx++;
-						break;
+			while (pos < pointer.size()) {
+				size_t end = pointer.find('/', pos + 1);
+				if (end == std::string_view::npos) {
+					end = pointer.size();
+				}
+				std::string token;
+				for (size_t k = pos + 1; k < end; ++k) { // ~1 -> /, ~0 -> ~
+					if (pointer[k] == '~' && k + 1 < end && (pointer[k + 1] == '0' || pointer[k + 1] == '1')) {
+						token.push_back(pointer[k + 1] == '0' ? '~' : '/');
+						++k;
+					}
+					else {
+						token.push_back(pointer[k]);
 					}
 				}
-				*/
+				pos = end;
 
-				/*
-				int d = clock();
-				std::cout << d - c << "ms\n";
-				bool now_object = false;
-				bool even = false;
+				const uint64_t last = type(i) == '{' || type(i) == '[' ? uint32_t(tape[i] & simdjson::internal::JSON_VALUE_MASK) - 1 : 0;
+				uint64_t found = 0;
 
-				for (tape_idx = 1; tape_idx < how_many; tape_idx++) {
+				if (type(i) == '{') {
+					for (uint64_t j = i + 1; j < last; j = next(j + 1)) {
+						if (get_str(j) == token) {
+							found = j + 1;
+							break;
+						}
+					}
+				}
+				else if (type(i) == '[') {
+					char* str_end = nullptr;
+					const uint64_t idx = strtoull(token.c_str(), &str_end, 10);
+					if (token.empty() || *str_end != '\0') {
+						return 0;
+					}
+					uint64_t count = 0;
+					for (uint64_t j = i + 1; j < last; j = next(j), ++count) {
+						if (count == idx) {
+							found = j;
+							break;
+						}
+					}
+				}
+				if (!found) {
+					return 0;
+				}
+				i = found;
+			}
+			return i;
+		}
+	};
 
-					//os << tape_idx << " : ";
-					tape_val = tape[tape_idx];
-					payload = tape_val & simdjson::internal::JSON_VALUE_MASK;
-					type = uint8_t(tape_val >> 56);
+	// array at pointer -> out, elements are read in parallel by thr_num threads. no UserType.
+	//  object at pointer -> out has one element. arguments : source, thr_num, out, pointer ( as Parse )
+	template <class T>
+	inline bool Deserialize(const std::unique_ptr<uint64_t[]>& tape, const std::unique_ptr<uint8_t[]>& string_buf, int thr_num,
+		std::vector<T>& out, std::string_view pointer = "") {
+		TapeReader reader(tape.get(), string_buf.get());
 
-					even = !even;
+		out.clear();
 
-					switch (type) {
-					case '"': // we have a string
-						if (now_object && even) {
-							key[tape_idx] = 1;
-						}
+		uint64_t i = reader.locate(pointer);
+		if (i == 0) {
+			std::cout << "not found " << pointer << "\n";
+			return false;
+		}
 
-						break;
-					case 'l': // we have a long int
-					//	if (tape_idx + 1 >= how_many) {
-					//		return false;
-						//}
-						//  os << "integer " << static_cast<int64_t>(tape[++tape_idx]) << "\n";
-						++tape_idx;
+		if (reader.type(i) != '[') {
+			out.resize(1);
+			if (!reader.read(i, out[0])) {
+				std::cout << "type is not matched or out of range in Deserialize\n";
+				return false;
+			}
+			return true;
+		}
 
-						break;
-					case 'u': // we have a long uint
-						//if (tape_idx + 1 >= how_many) {
-						//	return false;
-						//}
-						//  os << "unsigned integer " << tape[++tape_idx] << "\n";
-						++tape_idx;
-						break;
-					case 'd': // we have a double
-					  //  os << "float ";
-						//if (tape_idx + 1 >= how_many) {
-						//	return false;
-						//}
+		std::vector<uint64_t> start;
+		const uint64_t last = uint32_t(tape[i] & simdjson::internal::JSON_VALUE_MASK) - 1;
+		start.reserve(((tape[i] & simdjson::internal::JSON_VALUE_MASK) >> 32) & simdjson::internal::JSON_COUNT_MASK);
+		for (uint64_t j = i + 1; j < last; j = reader.next(j)) {
+			start.push_back(j);
+		}
 
-						// double answer;
-						// std::memcpy(&answer, &tape[++tape_idx], sizeof(answer));
-					   //  os << answer << '\n';
-						++tape_idx;
-						break;
-					case 'n': // we have a null
-					   // os << "null\n";
-						break;
-					case 't': // we have a true
-					   // os << "true\n";
-						break;
-					case 'f': // we have a false
-					  //  os << "false\n";
-						break;
-					case '{': // we have an object
-					 //   os << "{\t// pointing to next tape location " << uint32_t(payload)
-					 //       << " (first node after the scope), "
-					  //      << " saturated count "
-					   //     << ((payload >> 32) & internal::JSON_COUNT_MASK) << "\n";
-						now_object = true; even = false;
-						//_stack.push_back(1);
-						//_stack2.push_back(0);
-						break;
-					case '}': // we end an object
-					  //  os << "}\t// pointing to previous tape location " << uint32_t(payload)
-					  //      << " (start of the scope)\n";
-						//_stack.pop_back();
-						//_stack2.pop_back();
+		out.resize(start.size());
 
-						now_object = key[uint32_t(payload) - 1] == 1; even = false;
-						break;
-					case '[': // we start an array
-					  //  os << "[\t// pointing to next tape location " << uint32_t(payload)
-					  //      << " (first node after the scope), "
-					  //      << " saturated count "
-					   //     << ((payload >> 32) & internal::JSON_COUNT_MASK) << "\n";
-						//_stack.push_back(0);
-						now_object = false; even = false;
-						break;
-					case ']': // we end an array
-					 //   os << "]\t// pointing to previous tape location " << uint32_t(payload)
-					  //      << " (start of the scope)\n";
-						//_stack.pop_back();
-						now_object = key[uint32_t(payload) - 1] == 1; even = false;
-						break;
-					case 'r': // we start and end with the root node
-					  // should we be hitting the root node?
-						break;
-					default:
+		if (thr_num <= 0) {
+			thr_num = std::thread::hardware_concurrency();
+		}
+		const size_t min_len = 1 << 10;
+		size_t n = std::max<size_t>(1, std::min<size_t>(thr_num, start.size() / min_len));
+
+		auto work = [&reader, &start, &out](size_t first, size_t last) {
+			for (size_t k = first; k < last; ++k) {
+				uint64_t j = start[k];
+				if (!reader.read(j, out[k])) {
+					return false;
+				}
+			}
+			return true;
+		};
 
-						return nullptr;
-					}
+		std::vector<std::future<bool>> thr(n);
+		for (size_t t = 1; t < n; ++t) {
+			thr[t] = std::async(std::launch::async, work, start.size() / n * t, t + 1 == n ? start.size() : start.size() / n * (t + 1));
+		}
+		bool ok = work(0, n == 1 ? start.size() : start.size() / n);
+		for (size_t t = 1; t < n; ++t) {
+			ok = thr[t].get() && ok;
+		}
+
+		if (!ok) {
+			std::cout << "type is not matched or out of range in Deserialize\n";
+			out.clear();
+		}
+		return ok;
+	}
+
+	template <class T>
+	inline bool Deserialize(const std::string& fileName, int thr_num, std::vector<T>& out, std::string_view pointer = "") {
+		std::unique_ptr<simdjson::dom::parser> parser(new simdjson::dom::parser());
+
+		auto x = parser->load(fileName);
+
+		if (x.error() != simdjson::error_code::SUCCESS) {
+			std::cout << x.error() << "\n";
+
+			return false;
+		}
+
+		return Deserialize(parser->raw_tape(), parser->raw_string_buf(), thr_num, out, pointer);
+	}
+
+	// callbacks of Visit, all empty. derive and hide what you need, calls are resolved at compile time. ( no virtual )
+	//  count of *_start is saturated child count of tape. ( JSON_COUNT_MASK )
+	class TapeVisitor {
+	public:
+		void on_object_start(uint32_t /*count*/) { }
+		void on_object_end() { }
+		void on_array_start(uint32_t /*count*/) { }
+		void on_array_end() { }
+		void on_key(std::string_view /*key*/) { }
+		void on_string(std::string_view /*str*/) { }
+		void on_int64(int64_t /*x*/) { }
+		void on_uint64(uint64_t /*x*/) { }
+		void on_double(double /*x*/) { }
+		void on_bool(bool /*x*/) { }
+		void on_null() { }
+	};
+
+	// tape[first, last) -> visitor, in order.
+	template <class Visitor>
+	inline void Visit(const uint64_t* tape, const uint8_t* string_buf, uint64_t first, uint64_t last, Visitor& visitor) {
+		for (uint64_t i = first; i < last; ++i) {
+			const uint64_t payload = tape[i] & simdjson::internal::JSON_VALUE_MASK;
+
+			switch ((int)(tape[i] >> 56)) {
+			case '{':
+				visitor.on_object_start(uint32_t((payload >> 32) & simdjson::internal::JSON_COUNT_MASK));
+				break;
+			case '}':
+				visitor.on_object_end();
+				break;
+			case '[':
+				visitor.on_array_start(uint32_t((payload >> 32) & simdjson::internal::JSON_COUNT_MASK));
+				break;
+			case ']':
+				visitor.on_array_end();
+				break;
+			case 'k':
+			case '"':
+			{
+				uint32_t len;
+				std::memcpy(&len, string_buf + payload, sizeof(uint32_t));
+				const std::string_view str(reinterpret_cast<const char*>(string_buf + payload + sizeof(uint32_t)), len);
+				if ((tape[i] >> 56) == 'k') {
+					visitor.on_key(str);
 				}
-				std::cout << clock() - d << "ms\n";*/
+				else {
+					visitor.on_string(str);
+				}
+			}
+			break;
+			case 'l':
+				visitor.on_int64(int64_t(tape[i + 1]));
+				++i;
+				break;
+			case 'u':
+				visitor.on_uint64(tape[i + 1]);
+				++i;
+				break;
+			case 'd':
+			{
+				double x;
+				std::memcpy(&x, &tape[i + 1], sizeof(double));
+				visitor.on_double(x);
+				++i;
+			}
+			break;
+			case 't':
+				visitor.on_bool(true);
+				break;
+			case 'f':
+				visitor.on_bool(false);
+				break;
+			case 'n':
+				visitor.on_null();
+				break;
+			default: // 'r'
+				break;
 			}
+		}
+	}
 
+	// whole document.
+	template <class Visitor>
+	inline void Visit(const std::unique_ptr<uint64_t[]>& tape, const std::unique_ptr<uint8_t[]>& string_buf, Visitor& visitor) {
+		const uint64_t length = tape[0] & simdjson::internal::JSON_VALUE_MASK;
+		Visit(tape.get(), string_buf.get(), 1, length - 1, visitor);
+	}
 
-			int b = clock();
+	// elements of array at pointer ( JSON Pointer, "" - top-level ) are split into visitors.size() parts,
+	//  visitors[k] visits k-th part in its own thread. no on_array_start/end for the array itself.
+	template <class Visitor>
+	inline bool VisitParallel(const std::unique_ptr<uint64_t[]>& tape, const std::unique_ptr<uint8_t[]>& string_buf, std::string_view pointer,
+		std::vector<Visitor>& visitors) {
+		TapeReader reader(tape.get(), string_buf.get());
 
-			std::cout << b - a << "ms\n";
+		const uint64_t i = reader.locate(pointer);
+		if (i == 0 || reader.type(i) != '[' || visitors.empty()) {
+			std::cout << "not array " << pointer << "\n";
+			return false;
+		}
 
-			start[thr_num] = length - 1;
+		std::vector<uint64_t> start;
+		const uint64_t last = uint32_t(tape[i] & simdjson::internal::JSON_VALUE_MASK) - 1;
+		for (uint64_t j = i + 1; j < last; j = reader.next(j)) {
+			start.push_back(j);
+		}
+		start.push_back(last);
+
+		const size_t n = visitors.size();
+		const size_t len = start.size() - 1;
+		std::vector<std::future<void>> thr(n);
+
+		for (size_t t = 1; t < n; ++t) {
+			const uint64_t first = start[len / n * t];
+			const uint64_t end = start[t + 1 == n ? len : len / n * (t + 1)];
+			thr[t] = std::async(std::launch::async, [&tape, &string_buf, &visitors, t, first, end]() {
+				Visit(tape.get(), string_buf.get(), first, end, visitors[t]);
+			});
+		}
+		Visit(tape.get(), string_buf.get(), start[0], start[n == 1 ? len : len / n], visitors[0]);
+		for (size_t t = 1; t < n; ++t) {
+			thr[t].get();
+		}
+		return true;
+	}
 
-			pool = (claujson::UserType*)calloc(length, sizeof(claujson::UserType));
+	template <class Visitor>
+	inline bool Visit(const std::string& fileName, Visitor& visitor) {
+		std::unique_ptr<simdjson::dom::parser> parser(new simdjson::dom::parser());
 
-			claujson::LoadData::parse(pool, *ut, string_buf, tape, length, start, thr_num, blocks); // 0 : use all thread..
+		auto x = parser->load(fileName);
 
-			int c = clock();
-			std::cout << c - b << "ms\n";
+		if (x.error() != simdjson::error_code::SUCCESS) {
+			std::cout << x.error() << "\n";
+
+			return false;
 		}
-		int c = clock();
-		std::cout << c - _ << "ms\n";
 
-		// claujson::LoadData::_save(std::cout, &ut);
+		Visit(parser->raw_tape(), parser->raw_string_buf(), visitor);
+		return true;
+	}
 
-		return pool;
+	template <class Visitor>
+	inline bool VisitParallel(const std::string& fileName, std::string_view pointer, std::vector<Visitor>& visitors) {
+		std::unique_ptr<simdjson::dom::parser> parser(new simdjson::dom::parser());
+
+		auto x = parser->load(fileName);
+
+		if (x.error() != simdjson::error_code::SUCCESS) {
+			std::cout << x.error() << "\n";
+
+			return false;
+		}
+
+		return VisitParallel(parser->raw_tape(), parser->raw_string_buf(), pointer, visitors);
 	}
 
-	inline int Parse_One(const std::string& str, Data& data) {
-		{
-			static simdjson::dom::parser test;
+	// T -> compact JSON, same Binding with TapeReader. no UserType.
+	class StructWriter {
+	public:
+		template <class T>
+		static void write(std::string& out, const T& x) {
+			if constexpr (std::is_same_v<T, bool>) {
+				out.append(x ? "true" : "false");
+			}
+			else if constexpr (std::is_integral_v<T>) {
+				char buf[32];
+				out.append(buf, std::is_signed_v<T> ? FormatInt64(buf, x) : FormatUInt64(buf, x));
+			}
+			else if constexpr (std::is_floating_point_v<T>) {
+				char buf[32];
+				out.append(buf, FormatDouble(buf, (double)x));
+			}
+			else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+				EscapeString(out, std::string_view(x));
+			}
+			else if constexpr (is_vector<T>::value) {
+				out.push_back('[');
+				for (size_t i = 0; i < x.size(); ++i) {
+					if (i > 0) {
+						out.push_back(',');
+					}
+					write(out, x[i]);
+				}
+				out.push_back(']');
+			}
+			else if constexpr (Binding<T>::value) {
+				constexpr auto fields = Binding<T>::fields();
+				bool first = true;
+
+				out.push_back('{');
+				std::apply([&](const auto&... f) {
+					((out.append(first ? "" : ","), first = false,
+						EscapeString(out, std::string_view(f.key.str, f.key.len)), out.push_back(':'), write(out, x.*(f.member))), ...);
+				}, fields);
+				out.push_back('}');
+			}
+			else {
+				static_assert(dependent_false<T>::value, "StructWriter, no Binding for type");
+			}
+		}
+	};
 
-			auto x = test.parse(str);
+	// x -> out ( appended ), std::vector is split into thr_num parts written to own buffers, then joined.
+	template <class T>
+	inline void Serialize(const T& x, std::string& out, int thr_num = 0) {
+		if constexpr (is_vector<T>::value) {
+			if (thr_num <= 0) {
+				thr_num = std::thread::hardware_concurrency();
+			}
+			const size_t min_len = 1 << 10;
+			const size_t n = std::max<size_t>(1, std::min<size_t>(thr_num, x.size() / min_len));
 
-			if (x.error() != simdjson::error_code::SUCCESS) {
-				std::cout << x.error() << "\n";
+			if (n > 1) {
+				std::vector<std::string> part(n);
+				std::vector<std::future<void>> thr(n);
 
-				return -1;
+				auto work = [&x, &part](size_t t, size_t first, size_t last) {
+					for (size_t i = first; i < last; ++i) {
+						if (i > first) {
+							part[t].push_back(',');
+						}
+						StructWriter::write(part[t], x[i]);
+					}
+				};
+
+				for (size_t t = 1; t < n; ++t) {
+					thr[t] = std::async(std::launch::async, work, t, x.size() / n * t, t + 1 == n ? x.size() : x.size() / n * (t + 1));
+				}
+				work(0, 0, x.size() / n);
+
+				size_t len = 2 + n;
+				for (size_t t = 0; t < n; ++t) {
+					if (t > 0) {
+						thr[t].get();
+					}
+					len += part[t].size();
+				}
+
+				out.reserve(out.size() + len);
+				out.push_back('[');
+				for (size_t t = 0; t < n; ++t) {
+					if (t > 0) {
+						out.push_back(',');
+					}
+					out.append(part[t]);
+				}
+				out.push_back(']');
+				return;
 			}
+		}
+
+		StructWriter::write(out, x);
+	}
 
-			const auto& tape = test.raw_tape();
-			const auto& string_buf = test.raw_string_buf();
+	template <class T>
+	inline bool Serialize(const std::string& fileName, const T& x, int thr_num = 0) {
+		std::string out;
+		Serialize(x, out, thr_num);
 
-			Convert(data, &tape[1], false, string_buf);
+		std::ofstream outFile;
+		outFile.open(fileName, std::ios::binary);
+		if (!outFile) {
+			std::cout << "can't open " << fileName << "\n";
+			return false;
 		}
-		return 0;
+		outFile.write(out.data(), out.size());
+		return bool(outFile);
+	}
+
+	inline bool ParseFrozen(const std::string& fileName, int thr_num, FrozenDocument& doc) {
+		std::unique_ptr<simdjson::dom::parser> parser(new simdjson::dom::parser());
+
+		auto x = parser->load(fileName);
+
+		if (x.error() != simdjson::error_code::SUCCESS) {
+			std::cout << x.error() << "\n";
+
+			return false;
+		}
+
+		return doc.Build(std::move(parser), thr_num);
 	}
 }
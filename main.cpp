@@ -70,8 +70,9 @@ int main(int argc, char* argv[])
 	
 	int a = clock();
 	std::vector<claujson::Block> blocks;
-	auto x = claujson::Parse(argv[1], 0, &ut, blocks);
-	claujson::PoolManager poolManager(x, std::move(blocks)); // using pool manager, add Item or remove
+	int64_t pool_size = 0;
+	auto x = claujson::Parse(argv[1], 0, &ut, blocks, &pool_size);
+	claujson::PoolManager poolManager(x, pool_size, std::move(blocks)); // using pool manager, add Item or remove
 	int b = clock();
 	std::cout << "total " << b - a << "ms\n";
 